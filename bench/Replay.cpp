@@ -0,0 +1,199 @@
+/* Copyright (C) 2015 TU Dortmund
+ * This file is part of LearnLib, http://www.learnlib.de/.
+ * 
+ * LearnLib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 3.0 as published by the Free Software Foundation.
+ * 
+ * LearnLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with LearnLib; if not, see
+ * <http://www.gnu.de/documents/lgpl.en.html>.
+ */
+
+// Replay.cpp
+// Replays a recorded learning session (see SessionLog.hpp) against a fresh
+// learner, without a JVM or SUL. Recorded answers and counterexamples are
+// fed to the learner in the recorded order; advances and query batches are
+// checked against the recording, to detect divergent replays. Deadlines
+// and cancellations are applied as recorded, so replays of sessions that
+// ran into timeouts may diverge. Forks are created but stay idle, so the
+// answers they received in the recorded session are missing.
+//
+// Usage: learnlib-libalf-replay <session file> [repetitions]
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <chrono>
+
+#include "LibAlf.hpp"
+#include "LibalfLearner.hpp"
+#include "SessionLog.hpp"
+
+namespace {
+
+struct Counts {
+	Counts(void) : advances(0), conjectures(0), answers(0), counterExamples(0), mismatches(0) {}
+
+	long advances;
+	long conjectures;
+	long answers;
+	long counterExamples;
+	long mismatches;
+};
+
+void mismatch(Counts &counts, long recordNo, const char *what)
+{
+	if (counts.mismatches++ == 0) {
+		std::fprintf(stderr, "record %ld: replay diverges (%s)\n", recordNo, what);
+	}
+}
+
+bool replay(SessionLog::Reader &reader, const std::string &spillPath, Counts &counts)
+{
+	SessionLog::Record rec;
+	if (!reader.next(rec) || rec.type != SessionLog::INIT) {
+		std::fprintf(stderr, "Session log does not start with an INIT record\n");
+		return false;
+	}
+
+	LibAlf session(std::vector<std::string>(1, rec.name));
+	std::vector<jint> opts(rec.ints.begin() + 1, rec.ints.end());
+	LibalfLearner *learner = session.createLearner(0, rec.ints[0], opts.size(), opts.empty() ? NULL : opts.data());
+	if (!learner) {
+		std::fprintf(stderr, "Algorithm %s is not available\n", rec.name.c_str());
+		return false;
+	}
+
+	std::vector<jbyte> saf;
+	std::vector<LibalfLearner *> forks;
+	long recordNo = 1;
+	while (reader.next(rec)) {
+		recordNo++;
+		switch (rec.type) {
+		case SessionLog::ADVANCE: {
+			// Advances are only recorded if the learner was not cancelled on
+			// entry, so a recorded cancellation has been reported before
+			if (learner->budget().cancelled()) {
+				learner->budget().acknowledge();
+			}
+			bool conjecture = learner->advance();
+			counts.advances++;
+			if (conjecture != (rec.ints[0] != 0)) {
+				mismatch(counts, recordNo, "advance result");
+			}
+			if (conjecture) {
+				counts.conjectures++;
+				// the encoding is part of the work done for the Java side
+				saf.resize(learner->computeConjectureSize());
+				learner->encodeConjecture(saf.data(), saf.size());
+				if (saf.size() != static_cast<size_t>(rec.ints[1])) {
+					mismatch(counts, recordNo, "conjecture size");
+				}
+			}
+			break;
+		}
+		case SessionLog::QUERIES: {
+			QueryBatch *batch = learner->getQueries();
+			if (batch->size() != static_cast<size_t>(rec.ints[0]) || SessionLog::hashBatch(*batch) != rec.hash) {
+				mismatch(counts, recordNo, "query batch");
+			}
+			delete batch;
+			break;
+		}
+		case SessionLog::ANSWERS:
+			learner->addEncodedAnswers(rec.words, rec.ints.data());
+			counts.answers += static_cast<long>(rec.words.size());
+			break;
+		case SessionLog::SAMPLES:
+			learner->addSamples(rec.words, rec.ints.data());
+			counts.answers += static_cast<long>(rec.words.size());
+			break;
+		case SessionLog::COUNTEREXAMPLE:
+			learner->addCounterExample(rec.words.front());
+			counts.counterExamples++;
+			break;
+		case SessionLog::CE_SHORTENING:
+			learner->setCounterExampleShortening(rec.ints[0] != 0);
+			break;
+		case SessionLog::POST_PROCESSING:
+			learner->setPostProcessing(rec.ints[0] != 0, rec.ints[1] != 0);
+			break;
+		case SessionLog::SPILL:
+			if (!learner->enableSpill(spillPath.c_str(), rec.value)) {
+				mismatch(counts, recordNo, "spill");
+			}
+			break;
+		case SessionLog::DEADLINE:
+			learner->budget().setDeadline(rec.value);
+			break;
+		case SessionLog::CANCEL:
+			learner->cancel();
+			break;
+		case SessionLog::FORK: {
+			LibalfLearner *clone = learner->fork();
+			if (!clone) {
+				mismatch(counts, recordNo, "fork");
+				break;
+			}
+			forks.push_back(clone);
+			break;
+		}
+		default:
+			mismatch(counts, recordNo, "unexpected record");
+			break;
+		}
+	}
+
+	for (std::vector<LibalfLearner *>::iterator it = forks.begin(); it != forks.end(); ++it) {
+		delete *it;
+	}
+	delete learner;
+	if (reader.error()) {
+		std::fprintf(stderr, "Session log is truncated after record %ld\n", recordNo);
+	}
+	return true;
+}
+
+}
+
+int main(int argc, char **argv)
+{
+	if (argc < 2 || argc > 3) {
+		std::fprintf(stderr, "Usage: %s <session file> [repetitions]\n", argv[0]);
+		return 1;
+	}
+	int repetitions = (argc > 2) ? std::atoi(argv[2]) : 1;
+
+	SessionLog::Reader reader;
+	if (!reader.open(argv[1])) {
+		std::fprintf(stderr, "Cannot read session log %s\n", argv[1]);
+		return 1;
+	}
+
+	Counts counts;
+	for (int i = 0; i < repetitions; i++) {
+		reader.rewind();
+		counts = Counts();
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		if (!replay(reader, std::string(argv[1]) + ".spill", counts)) {
+			return 1;
+		}
+		double millis = std::chrono::duration_cast<std::chrono::microseconds>(
+				std::chrono::steady_clock::now() - start).count() / 1e3;
+		std::printf("run %d: %ld advances, %ld conjectures, %ld answers, %ld counterexamples, %.1f ms\n",
+				i + 1, counts.advances, counts.conjectures, counts.answers, counts.counterExamples, millis);
+	}
+
+	if (counts.mismatches) {
+		std::printf("%ld mismatches with the recording\n", counts.mismatches);
+		return 2;
+	}
+	return 0;
+}
@@ -0,0 +1,180 @@
+/* Copyright (C) 2015 TU Dortmund
+ * This file is part of LearnLib, http://www.learnlib.de/.
+ * 
+ * LearnLib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 3.0 as published by the Free Software Foundation.
+ * 
+ * LearnLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with LearnLib; if not, see
+ * <http://www.gnu.de/documents/lgpl.en.html>.
+ */
+
+// Workload.cpp
+// Native learning workload, which learns random target DFAs with each of
+// the active learning algorithms, without a JVM. It serves as the training
+// run for profile-guided builds, and as a reproducible benchmark: the
+// targets only depend on the seed, and the time spent per algorithm is
+// reported.
+//
+// Usage: learnlib-libalf-workload [scale [seed]]
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <chrono>
+
+#include <stdint.h>
+
+#include "LibAlf.hpp"
+#include "LibalfLearner.hpp"
+#include "HypothesisDiff.hpp"
+
+namespace {
+
+const char *const ALGORITHMS[] = {
+	"ANGLUIN_SIMPLE_DFA",
+	"ANGLUIN_COL_DFA",
+	"KV_DFA",
+	"RS_DFA",
+	"NLSTAR"
+};
+const size_t NUM_ALGORITHMS = sizeof(ALGORITHMS) / sizeof(ALGORITHMS[0]);
+
+const int ALPHABET_SIZE = 4;
+const int BASE_STATES = 40;
+
+// Linear congruential generator, for targets independent of the C library
+class Random {
+public:
+	Random(uint64_t seed) : m_state(seed) {}
+
+	int next(int bound)
+	{
+		m_state = m_state * 6364136223846793005ull + 1442695040888963407ull;
+		return static_cast<int>((m_state >> 33) % static_cast<uint64_t>(bound));
+	}
+
+private:
+	uint64_t m_state;
+};
+
+libalf::finite_automaton randomDFA(int numStates, Random &rnd)
+{
+	libalf::finite_automaton fa;
+	fa.is_deterministic = true;
+	fa.input_alphabet_size = ALPHABET_SIZE;
+	fa.state_count = numStates;
+	fa.initial_states.insert(0);
+	for (int q = 0; q < numStates; q++) {
+		fa.output_mapping[q] = (rnd.next(2) == 0);
+		for (int a = 0; a < ALPHABET_SIZE; a++) {
+			fa.transitions[q][a].insert(rnd.next(numStates));
+		}
+	}
+	return fa;
+}
+
+struct Result {
+	Result(void) : rounds(0), queries(0), symbols(0), nanos(0), states(0) {}
+
+	long rounds;
+	long queries;
+	long symbols;
+	long long nanos;
+	int states;
+};
+
+bool learn(LibalfLearner &learner, const FlatAutomaton &target, const FlatAutomaton &nfaTarget, Result &result)
+{
+	for (;;) {
+		if (!learner.advance()) {
+			QueryBatch *batch = learner.getQueries();
+			if (batch->empty()) {
+				delete batch;
+				return false;
+			}
+			for (QueryBatch::iterator it = batch->begin(); it != batch->end(); ++it) {
+				int q = target.initialStates().front();
+				for (Word::const_iterator sit = it->begin(); sit != it->end(); ++sit) {
+					q = target.successor(q, *sit);
+				}
+				result.queries++;
+				result.symbols += static_cast<long>(it->size());
+				learner.addEncodedAnswer(*it, target.isAccepting(q));
+			}
+			delete batch;
+			continue;
+		}
+
+		result.rounds++;
+		std::vector<jbyte> saf(learner.computeConjectureSize());
+		learner.encodeConjecture(saf.data(), saf.size());
+
+		const FlatAutomaton *hyp = learner.hypothesis();
+		if (!hyp) {
+			return false;
+		}
+		QueryBatch ces;
+		HypothesisDiff::Stats stats;
+		const FlatAutomaton &ref = hyp->isDeterministic() ? target : nfaTarget;
+		if (HypothesisDiff::compare(ref, *hyp, 1, ces, stats) != HypothesisDiff::OK) {
+			return false;
+		}
+		if (ces.empty()) {
+			result.states = hyp->numStates();
+			return true;
+		}
+		learner.addCounterExample(ces.front());
+	}
+}
+
+}
+
+int main(int argc, char **argv)
+{
+	int scale = (argc > 1) ? std::atoi(argv[1]) : 4;
+	uint64_t seed = (argc > 2) ? std::strtoull(argv[2], NULL, 10) : 1;
+	if (scale <= 0) {
+		std::fprintf(stderr, "Usage: %s [scale [seed]]\n", argv[0]);
+		return 1;
+	}
+
+	LibAlf session(std::vector<std::string>(ALGORITHMS, ALGORITHMS + NUM_ALGORITHMS));
+
+	std::printf("%-20s %8s %8s %12s %14s %12s\n", "algorithm", "targets", "rounds", "queries", "symbols", "millis");
+	bool ok = true;
+	for (size_t alg = 0; alg < NUM_ALGORITHMS; alg++) {
+		Random rnd(seed);
+		Result total;
+		for (int i = 1; i <= scale; i++) {
+			libalf::finite_automaton fa = randomDFA(BASE_STATES * i, rnd);
+			FlatAutomaton target(fa, true);
+			FlatAutomaton nfaTarget(fa, false);
+
+			LibalfLearner *learner = session.createLearner(static_cast<jint>(alg), ALPHABET_SIZE, 0, NULL);
+			if (!learner) {
+				std::fprintf(stderr, "Algorithm %s is not available\n", ALGORITHMS[alg]);
+				return 1;
+			}
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			if (!learn(*learner, target, nfaTarget, total)) {
+				std::fprintf(stderr, "%s: learning target %d failed\n", ALGORITHMS[alg], i);
+				ok = false;
+			}
+			total.nanos += std::chrono::duration_cast<std::chrono::nanoseconds>(
+					std::chrono::steady_clock::now() - start).count();
+			delete learner;
+		}
+		std::printf("%-20s %8d %8ld %12ld %14ld %12.1f\n", ALGORITHMS[alg], scale,
+				total.rounds, total.queries, total.symbols, total.nanos / 1e6);
+	}
+
+	return ok ? 0 : 1;
+}
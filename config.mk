@@ -18,6 +18,7 @@ else ifeq (${OS}, Darwin) # Mac OS
 	JNI_INCLUDE = ${JAVA_INCLUDE}/darwin
 else ifeq (${OS}, Linux) # Linux
 	LIBEXT=so
+	LDFLAGS+=-ldl
 	JNI_INCLUDE = ${JAVA_INCLUDE}/linux
 else
 	$(error Unsupported operating system ${OS})
@@ -0,0 +1,482 @@
+/* Copyright (C) 2015 TU Dortmund
+ * This file is part of LearnLib, http://www.learnlib.de/.
+ * 
+ * LearnLib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 3.0 as published by the Free Software Foundation.
+ * 
+ * LearnLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with LearnLib; if not, see
+ * <http://www.gnu.de/documents/lgpl.en.html>.
+ */
+
+// Daemon.cpp
+// Standalone learner daemon, hosting LibAlf sessions and learners for
+// clients connecting via a Unix domain socket. Each client is served by a
+// dedicated thread, and owns the sessions and learners it creates.
+//
+// Usage: learnlib-libalf-daemon <socket path>
+
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+#include <thread>
+#include <exception>
+
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "LibAlf.hpp"
+#include "LibalfLearner.hpp"
+#include "RemoteProtocol.hpp"
+#include "WordCodec.hpp"
+
+using namespace RemoteProtocol;
+
+// Links the budget of a learner to the cancellation requests of the client
+// while a request is processed
+class CancellationLink {
+public:
+	CancellationLink(Budget &budget, const CancelControl *ctrl, uint32_t seq) : m_budget(budget)
+	{
+		m_budget.linkCancellation(&ctrl->cancelSeq, seq);
+	}
+	~CancellationLink(void)
+	{
+		m_budget.linkCancellation(NULL, 0);
+	}
+
+private:
+	Budget &m_budget;
+};
+
+class ClientHandler {
+public:
+	ClientHandler(int fd) : m_fd(fd), m_segment(NULL), m_channel(NULL), m_cancel(NULL), m_nextId(1) {}
+	~ClientHandler(void);
+
+	void run(void);
+
+private:
+	bool handshake(void);
+	bool dispatch(const MessageHeader &req, const std::vector<char> &payload, MessageHeader &resp, std::vector<char> &respPayload);
+	LibalfLearner *learner(uint64_t id);
+	void closeCursors(uint64_t learnerId);
+
+private:
+	struct Cursor {
+		uint64_t learnerId;
+		QueryCursor *cursor;
+	};
+
+	int m_fd;
+	void *m_segment;
+	Channel *m_channel;
+	CancelControl *m_cancel;
+	uint64_t m_nextId;
+	std::map<uint64_t, LibAlf *> m_sessions;
+	std::map<uint64_t, LibalfLearner *> m_learners;
+	std::map<uint64_t, Cursor> m_cursors;
+};
+
+ClientHandler::~ClientHandler(void)
+{
+	for (std::map<uint64_t, Cursor>::iterator it = m_cursors.begin(); it != m_cursors.end(); ++it) {
+		delete it->second.cursor;
+	}
+	for (std::map<uint64_t, LibalfLearner *>::iterator it = m_learners.begin(); it != m_learners.end(); ++it) {
+		delete it->second;
+	}
+	for (std::map<uint64_t, LibAlf *>::iterator it = m_sessions.begin(); it != m_sessions.end(); ++it) {
+		delete it->second;
+	}
+	delete m_channel;
+	if (m_segment) {
+		releaseSegment(m_segment);
+	}
+	close(m_fd);
+}
+
+bool ClientHandler::handshake(void)
+{
+	MessageHeader hdr;
+	if (!receiveAll(m_fd, &hdr, sizeof(hdr)) || hdr.code != HELLO || hdr.payloadLen > 255) {
+		return false;
+	}
+	std::string name(hdr.payloadLen, '\0');
+	if (!receiveAll(m_fd, &name[0], name.size())) {
+		return false;
+	}
+
+	MessageHeader resp;
+	std::memset(&resp, 0, sizeof(resp));
+	m_segment = openSegment(name.c_str());
+	resp.code = m_segment ? STATUS_OK : STATUS_ERROR;
+	if (!sendAll(m_fd, &resp, sizeof(resp)) || !m_segment) {
+		return false;
+	}
+	m_channel = new Channel(m_fd, m_segment, false);
+	m_cancel = cancelControl(m_segment);
+	return true;
+}
+
+LibalfLearner *ClientHandler::learner(uint64_t id)
+{
+	std::map<uint64_t, LibalfLearner *>::iterator it = m_learners.find(id);
+	return (it != m_learners.end()) ? it->second : NULL;
+}
+
+// Cursors refer to the knowledgebase of their learner, so they are closed with it
+void ClientHandler::closeCursors(uint64_t learnerId)
+{
+	std::map<uint64_t, Cursor>::iterator it = m_cursors.begin();
+	while (it != m_cursors.end()) {
+		if (it->second.learnerId == learnerId) {
+			delete it->second.cursor;
+			m_cursors.erase(it++);
+		}
+		else {
+			++it;
+		}
+	}
+}
+
+/*
+ * Encodes the current conjecture of the learner into the response. Returns
+ * false if the encoding would exceed the payload limit.
+ */
+static bool encodeConjecture(LibalfLearner *l, MessageHeader &resp, std::vector<char> &respPayload)
+{
+	size_t size = l->computeConjectureSize();
+	if (size > MAX_PAYLOAD_LEN) {
+		return false;
+	}
+	respPayload.resize(size);
+	if (!l->encodeConjecture(reinterpret_cast<jbyte *>(respPayload.data()), respPayload.size())) {
+		respPayload.clear();
+		resp.code = STATUS_TIMED_OUT;
+		resp.arg = 1;
+		return true;
+	}
+	resp.code = STATUS_CONJECTURE;
+	return true;
+}
+
+static void appendInt32s(std::vector<char> &buf, const int32_t *data, size_t count)
+{
+	const char *bytes = reinterpret_cast<const char *>(data);
+	buf.insert(buf.end(), bytes, bytes + count * sizeof(int32_t));
+}
+
+bool ClientHandler::dispatch(const MessageHeader &req, const std::vector<char> &payload,
+		MessageHeader &resp, std::vector<char> &respPayload)
+{
+	const int32_t *ints = reinterpret_cast<const int32_t *>(payload.data());
+	size_t numInts = payload.size() / sizeof(int32_t);
+
+	switch (req.code) {
+	case CREATE_SESSION: {
+		std::vector<std::string> names;
+		size_t start = 0;
+		for (size_t i = 0; i < payload.size(); i++) {
+			if (payload[i] == '\0') {
+				names.push_back(std::string(&payload[start], i - start));
+				start = i + 1;
+			}
+		}
+		uint64_t id = m_nextId++;
+		m_sessions[id] = new LibAlf(names);
+		resp.arg = static_cast<int64_t>(id);
+		return true;
+	}
+	case DISPOSE_SESSION: {
+		std::map<uint64_t, LibAlf *>::iterator it = m_sessions.find(req.id);
+		if (it == m_sessions.end()) {
+			return false;
+		}
+		delete it->second;
+		m_sessions.erase(it);
+		return true;
+	}
+	case CREATE_LEARNER: {
+		std::map<uint64_t, LibAlf *>::iterator it = m_sessions.find(static_cast<uint64_t>(req.arg));
+		if (it == m_sessions.end() || numInts < 2) {
+			return false;
+		}
+		std::vector<jint> opts(ints + 2, ints + numInts);
+		LibalfLearner *l = it->second->createLearner(ints[0], ints[1], opts.size(), opts.empty() ? NULL : opts.data());
+		if (!l) {
+			return false;
+		}
+		uint64_t id = m_nextId++;
+		m_learners[id] = l;
+		resp.arg = static_cast<int64_t>(id);
+		int32_t booleanAnswers = l->booleanAnswers() ? 1 : 0;
+		appendInt32s(respPayload, &booleanAnswers, 1);
+		return true;
+	}
+	case DISPOSE_LEARNER: {
+		std::map<uint64_t, LibalfLearner *>::iterator it = m_learners.find(req.id);
+		if (it == m_learners.end()) {
+			return false;
+		}
+		closeCursors(it->first);
+		delete it->second;
+		m_learners.erase(it);
+		return true;
+	}
+	case FETCH_QUERY_PAGE: {
+		std::map<uint64_t, Cursor>::iterator it = m_cursors.find(req.id);
+		if (it == m_cursors.end() || numInts != 2) {
+			return false;
+		}
+		// A page always holds at least one word, so a single huge query may
+		// still exceed the payload limit, and is then reported as an error.
+		size_t maxQueries = (ints[0] > 0) ? static_cast<size_t>(ints[0]) : 0;
+		size_t maxInts = (ints[1] > 0) ? static_cast<size_t>(ints[1]) : 0;
+		size_t intLimit = static_cast<size_t>(MAX_PAYLOAD_LEN / sizeof(int32_t));
+		if (!maxInts || maxInts > intLimit) {
+			maxInts = intLimit;
+		}
+		QueryBatch page;
+		if (!it->second.cursor->nextPage(page, maxQueries, maxInts)) {
+			resp.arg = 0;
+			return true;
+		}
+		std::vector<jint> enc(WordCodec::encodedBatchSize(page));
+		WordCodec::encodeBatch(enc.data(), page);
+		appendInt32s(respPayload, enc.data(), enc.size());
+		resp.arg = 1;
+		return true;
+	}
+	case CLOSE_QUERY_CURSOR: {
+		std::map<uint64_t, Cursor>::iterator it = m_cursors.find(req.id);
+		if (it == m_cursors.end()) {
+			return false;
+		}
+		delete it->second.cursor;
+		m_cursors.erase(it);
+		return true;
+	}
+	}
+
+	LibalfLearner *l = learner(req.id);
+	if (!l) {
+		return false;
+	}
+	CancellationLink link(l->budget(), m_cancel, req.seq);
+
+	switch (req.code) {
+	case ADVANCE: {
+		l->budget().setDeadline(req.arg);
+		if (l->budget().expired()) {
+			resp.code = STATUS_TIMED_OUT;
+			return true;
+		}
+		if (!l->advance()) {
+			if (l->budget().expired()) {
+				resp.code = STATUS_TIMED_OUT;
+			}
+			return true;
+		}
+		return encodeConjecture(l, resp, respPayload);
+	}
+	case GET_CONJECTURE:
+		l->budget().setDeadline(req.arg);
+		if (l->hasConjecture()) {
+			return encodeConjecture(l, resp, respPayload);
+		}
+		return true;
+	case GET_QUERIES: {
+		QueryBatch *batch = l->getQueries();
+		std::vector<jint> enc(WordCodec::encodedBatchSize(*batch));
+		WordCodec::encodeBatch(enc.data(), *batch);
+		delete batch;
+		appendInt32s(respPayload, enc.data(), enc.size());
+		return true;
+	}
+	case OPEN_QUERY_CURSOR: {
+		Cursor cursor;
+		cursor.learnerId = req.id;
+		cursor.cursor = l->openQueryCursor();
+		uint64_t id = m_nextId++;
+		m_cursors[id] = cursor;
+		resp.arg = static_cast<int64_t>(id);
+		return true;
+	}
+	case ADD_ANSWERS: {
+		if (numInts < 1 || ints[0] < 0) {
+			return false;
+		}
+		size_t numWords = static_cast<size_t>(ints[0]);
+		if (numInts - 1 < numWords) {
+			return false;
+		}
+		const jint *p = ints + 1;
+		const jint *answers = ints + numInts - numWords;
+		QueryBatch words;
+		for (size_t i = 0; i < numWords; i++) {
+			words.push_back(Word());
+			p = WordCodec::decodeWord(p, answers, words.back());
+			if (!p) {
+				return false;
+			}
+		}
+		resp.arg = l->addEncodedAnswers(words, answers) ? 1 : 0;
+		return true;
+	}
+	case ADD_SAMPLES: {
+		if (numInts < 1 || ints[0] < 0) {
+			return false;
+		}
+		size_t numSamples = static_cast<size_t>(ints[0]);
+		if (numInts - 1 < numSamples) {
+			return false;
+		}
+		const jint *outputs = ints + numInts - numSamples;
+		resp.arg = static_cast<int64_t>(l->addEncodedSamples(numSamples, ints + 1, outputs, outputs));
+		return true;
+	}
+	case ADD_COUNTEREXAMPLE: {
+		ScratchWord &ce = l->scratchWord();
+		ce.assign(ints, ints + numInts);
+		l->addCounterExample(ce.word());
+		return true;
+	}
+	case SET_CE_SHORTENING:
+		resp.arg = l->setCounterExampleShortening(req.arg != 0) ? 1 : 0;
+		return true;
+	case GET_CE_STATS: {
+		const CEShortening::Stats *stats = l->getCounterExampleStats();
+		if (!stats) {
+			return false;
+		}
+		jlong statsEnc[] = {
+			stats->counterExamples, stats->shortened, stats->symbolsIn, stats->symbolsOut, stats->knowledgeHits
+		};
+		const char *bytes = reinterpret_cast<const char *>(statsEnc);
+		respPayload.assign(bytes, bytes + sizeof(statsEnc));
+		return true;
+	}
+	}
+
+	return false;
+}
+
+void ClientHandler::run(void)
+{
+	if (!handshake()) {
+		return;
+	}
+
+	MessageHeader req;
+	std::vector<char> payload;
+	std::vector<char> respPayload;
+	while (m_channel->receiveHeader(req)) {
+		// The length is untrusted; the client is dropped if it is out of
+		// bounds or cannot be allocated.
+		if (req.payloadLen > MAX_PAYLOAD_LEN) {
+			std::fprintf(stderr, "learnlib-libalf-daemon: payload of %llu bytes exceeds limit\n",
+					static_cast<unsigned long long>(req.payloadLen));
+			return;
+		}
+		try {
+			payload.resize(static_cast<size_t>(req.payloadLen));
+		}
+		catch (std::exception &ex) {
+			std::fprintf(stderr, "learnlib-libalf-daemon: cannot receive payload: %s\n", ex.what());
+			return;
+		}
+		if (!m_channel->receivePayload(payload.data(), payload.size())) {
+			return;
+		}
+
+		MessageHeader resp;
+		std::memset(&resp, 0, sizeof(resp));
+		resp.code = STATUS_OK;
+		respPayload.clear();
+
+		// Failures of a single request, including exceptions thrown by
+		// libalf or allocation failures, are reported to the client.
+		bool ok;
+		try {
+			ok = dispatch(req, payload, resp, respPayload);
+		}
+		catch (std::exception &ex) {
+			std::fprintf(stderr, "learnlib-libalf-daemon: request %d failed: %s\n", req.code, ex.what());
+			ok = false;
+		}
+		catch (...) {
+			ok = false;
+		}
+		// The client would drop the connection on a larger response
+		if (ok && respPayload.size() > MAX_PAYLOAD_LEN) {
+			std::fprintf(stderr, "learnlib-libalf-daemon: response of %llu bytes to request %d exceeds limit\n",
+					static_cast<unsigned long long>(respPayload.size()), req.code);
+			ok = false;
+		}
+		if (!ok) {
+			resp.code = STATUS_ERROR;
+			respPayload.clear();
+		}
+
+		resp.payloadLen = respPayload.size();
+		if (!m_channel->send(resp, respPayload.data())) {
+			return;
+		}
+	}
+}
+
+static void serveClient(int fd)
+{
+	ClientHandler handler(fd);
+	handler.run();
+}
+
+int main(int argc, char **argv)
+{
+	if (argc != 2) {
+		std::fprintf(stderr, "Usage: %s <socket path>\n", argv[0]);
+		return 1;
+	}
+
+	signal(SIGPIPE, SIG_IGN);
+
+	struct sockaddr_un addr;
+	std::memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	if (std::strlen(argv[1]) >= sizeof(addr.sun_path)) {
+		std::fprintf(stderr, "Socket path too long: %s\n", argv[1]);
+		return 1;
+	}
+	std::strcpy(addr.sun_path, argv[1]);
+
+	int listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (listenFd < 0) {
+		std::perror("socket");
+		return 1;
+	}
+	unlink(argv[1]);
+	if (bind(listenFd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) != 0 || listen(listenFd, 16) != 0) {
+		std::perror("bind");
+		return 1;
+	}
+
+	for (;;) {
+		int fd = accept(listenFd, NULL, NULL);
+		if (fd < 0) {
+			continue;
+		}
+		configureSocket(fd);
+		std::thread(serveClient, fd).detach();
+	}
+}
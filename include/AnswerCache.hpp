@@ -0,0 +1,102 @@
+/* Copyright (C) 2015 TU Dortmund
+ * This file is part of LearnLib, http://www.learnlib.de/.
+ * 
+ * LearnLib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 3.0 as published by the Free Software Foundation.
+ * 
+ * LearnLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with LearnLib; if not, see
+ * <http://www.gnu.de/documents/lgpl.en.html>.
+ */
+
+// AnswerCache.hpp
+// Membership query answers shared between a learner and its forks, so that
+// no query needs to be answered twice within a family of forked learners.
+
+#ifndef LEARNLIB_LIBALF_NATIVE_ANSWERCACHE_HPP
+#define LEARNLIB_LIBALF_NATIVE_ANSWERCACHE_HPP
+
+#include <vector>
+#include <mutex>
+#include <stdint.h>
+
+#include <jni.h>
+
+#include "QueryCursor.hpp"
+
+/*
+ * The answers are stored in a prefix tree, so that words sharing a prefix
+ * share its nodes, and every node takes a few bytes in flat arrays instead
+ * of a copy of its word. The children of all nodes are kept in a single
+ * open-addressing hash table, keyed by parent node and symbol.
+ */
+class AnswerCache {
+public:
+	AnswerCache(void);
+
+	bool lookup(const Word &w, jint &answer);
+
+	void store(const Word &w, jint answer)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		storeLocked(w, answer);
+	}
+
+	// Stores the answers to all words of the batch, under a single lock
+	void storeAll(const QueryBatch &batch, const jint *answers)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		for (QueryBatch::const_iterator it = batch.begin(); it != batch.end(); ++it) {
+			storeLocked(*it, *answers++);
+		}
+	}
+
+	// Number of queries answered from the cache
+	jlong hits(void) const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_hits;
+	}
+
+	// Number of stored answers
+	jlong size(void) const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_size;
+	}
+
+private:
+	typedef uint32_t Node;
+
+	struct Slot {
+		uint64_t key; // 0 for empty slots, see childKey
+		Node child;
+	};
+
+	static uint64_t childKey(Node parent, int sym)
+	{
+		return (static_cast<uint64_t>(parent + 1) << 32) | static_cast<uint32_t>(sym);
+	}
+
+	void storeLocked(const Word &w, jint answer);
+	// Returns the slot holding the given key, or the empty slot where it belongs
+	size_t findSlot(uint64_t key) const;
+	void grow(void);
+
+private:
+	mutable std::mutex m_mutex;
+	std::vector<Slot> m_slots;
+	size_t m_usedSlots;
+	std::vector<jint> m_answers; // by node, the root being the empty word
+	std::vector<bool> m_answered;
+	jlong m_size;
+	jlong m_hits;
+};
+
+#endif // LEARNLIB_LIBALF_NATIVE_ANSWERCACHE_HPP
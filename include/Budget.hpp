@@ -0,0 +1,123 @@
+/* Copyright (C) 2015 TU Dortmund
+ * This file is part of LearnLib, http://www.learnlib.de/.
+ *
+ * LearnLib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 3.0 as published by the Free Software Foundation.
+ *
+ * LearnLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with LearnLib; if not, see
+ * <http://www.gnu.de/documents/lgpl.en.html>.
+ */
+
+// Budget.hpp
+// Cooperative cancellation flag and wall-clock deadline of a learner. The
+// cancellation flag may be set from any thread; long-running operations
+// poll expired() at safe points.
+//
+// The safe points lie between calls into libalf: on entry to advance,
+// between the rounds in which pending queries are resolved natively, and
+// while post-processing or encoding a conjecture. A single call to the
+// advance method of a libalf algorithm cannot be interrupted, so a deadline
+// may be overrun by the duration of that call. A conjecture whose encoding
+// was interrupted is kept by the learner, and can be fetched again.
+
+#ifndef LEARNLIB_LIBALF_NATIVE_BUDGET_HPP
+#define LEARNLIB_LIBALF_NATIVE_BUDGET_HPP
+
+#include <atomic>
+#include <chrono>
+
+#include <stdint.h>
+
+#include <jni.h>
+
+class Budget {
+public:
+	typedef std::chrono::steady_clock Clock;
+
+public:
+	Budget(void) : m_cancelled(false), m_deadline(0), m_cancelFlag(NULL), m_cancelValue(0) {}
+
+	void cancel(void)
+	{
+		m_cancelled.store(true);
+	}
+
+	/*
+	 * Sets the deadline to the given number of milliseconds from now. A
+	 * non-positive value removes the deadline.
+	 */
+	void setDeadline(jlong millis)
+	{
+		if (millis <= 0) {
+			m_deadline.store(0);
+			return;
+		}
+		Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(millis);
+		m_deadline.store(deadline.time_since_epoch().count());
+	}
+
+	/*
+	 * Additionally treats the budget as cancelled while the given flag,
+	 * which may be set from any thread, holds the given value. A NULL flag
+	 * removes the link. Only the thread polling the budget may link it.
+	 */
+	void linkCancellation(const std::atomic<uint32_t> *flag, uint32_t value)
+	{
+		m_cancelFlag = flag;
+		m_cancelValue = value;
+	}
+
+	bool cancelled(void) const
+	{
+		return m_cancelled.load(std::memory_order_relaxed)
+			|| (m_cancelFlag && m_cancelFlag->load(std::memory_order_relaxed) == m_cancelValue);
+	}
+
+	bool expired(void) const
+	{
+		if (cancelled()) {
+			return true;
+		}
+		Clock::rep deadline = m_deadline.load(std::memory_order_relaxed);
+		return (deadline && Clock::now().time_since_epoch().count() >= deadline);
+	}
+
+	/*
+	 * Returns the number of milliseconds until the deadline (at least 1), or
+	 * 0 if no deadline is set.
+	 */
+	jlong remainingMillis(void) const
+	{
+		Clock::rep deadline = m_deadline.load(std::memory_order_relaxed);
+		if (!deadline) {
+			return 0;
+		}
+		Clock::duration remaining = Clock::duration(deadline) - Clock::now().time_since_epoch();
+		jlong millis = std::chrono::duration_cast<std::chrono::milliseconds>(remaining).count();
+		return (millis > 0) ? millis : 1;
+	}
+
+	/*
+	 * Clears a pending cancellation request, after it has been reported to
+	 * the caller. The deadline stays in effect until it is reset.
+	 */
+	void acknowledge(void)
+	{
+		m_cancelled.store(false);
+	}
+
+private:
+	std::atomic<bool> m_cancelled;
+	std::atomic<Clock::rep> m_deadline;
+	const std::atomic<uint32_t> *m_cancelFlag;
+	uint32_t m_cancelValue;
+};
+
+#endif // LEARNLIB_LIBALF_NATIVE_BUDGET_HPP
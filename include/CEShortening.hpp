@@ -0,0 +1,58 @@
+/* Copyright (C) 2015 TU Dortmund
+ * This file is part of LearnLib, http://www.learnlib.de/.
+ * 
+ * LearnLib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 3.0 as published by the Free Software Foundation.
+ * 
+ * LearnLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with LearnLib; if not, see
+ * <http://www.gnu.de/documents/lgpl.en.html>.
+ */
+
+// CEShortening.hpp
+// Shortening of counterexamples against the last hypothesis, using only
+// the answers already stored in the knowledgebase.
+
+#ifndef LEARNLIB_LIBALF_NATIVE_CESHORTENING_HPP
+#define LEARNLIB_LIBALF_NATIVE_CESHORTENING_HPP
+
+#include <list>
+
+#include <jni.h>
+
+#include <libalf/knowledgebase.h>
+
+#include "FlatAutomaton.hpp"
+
+namespace CEShortening {
+
+struct Stats {
+	Stats(void) : counterExamples(0), shortened(0), symbolsIn(0), symbolsOut(0), knowledgeHits(0) {}
+
+	jlong counterExamples; // number of counterexamples seen
+	jlong shortened; // number of counterexamples that could be shortened
+	jlong symbolsIn; // total length before shortening
+	jlong symbolsOut; // total length after shortening
+	jlong knowledgeHits; // lookups answered from the knowledgebase (no SUL query is issued either way)
+};
+
+/*
+ * Tries to shorten the counterexample ce for the DFA hypothesis hyp in place.
+ * Loops in the run of the hypothesis are cut out, and a Rivest-Schapire
+ * style binary search over the decomposition acc(q_i) w[i..] is performed.
+ * Only answers already present in the knowledgebase are used; whenever a
+ * required answer is unknown, the best counterexample found so far is kept.
+ * Returns true if ce was replaced by a shorter word.
+ */
+bool shortenDFA(std::list<int> &ce, const FlatAutomaton &hyp,
+		const libalf::knowledgebase<bool> &kb, Stats &stats);
+
+};
+
+#endif // LEARNLIB_LIBALF_NATIVE_CESHORTENING_HPP
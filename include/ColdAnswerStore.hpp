@@ -0,0 +1,125 @@
+/* Copyright (C) 2015 TU Dortmund
+ * This file is part of LearnLib, http://www.learnlib.de/.
+ * 
+ * LearnLib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 3.0 as published by the Free Software Foundation.
+ * 
+ * LearnLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with LearnLib; if not, see
+ * <http://www.gnu.de/documents/lgpl.en.html>.
+ */
+
+// ColdAnswerStore.hpp
+// Cold tier of the answer store of a learner: membership query answers
+// spilled from the knowledgebase into a memory-mapped file, sorted by word.
+
+#ifndef LEARNLIB_LIBALF_NATIVE_COLDANSWERSTORE_HPP
+#define LEARNLIB_LIBALF_NATIVE_COLDANSWERSTORE_HPP
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <utility>
+#include <cstddef>
+#include <stdint.h>
+
+#include <jni.h>
+
+#include "QueryCursor.hpp"
+
+/*
+ * Every spill writes a new run file, which is never modified afterwards.
+ * A run file holds one record per answered word, in lexicographic order of
+ * the words, so that all extensions of a word directly follow it. A record
+ * consists of the word length, the symbols and the encoded answer, all as
+ * variable-length integers. Only the offset of every INDEX_INTERVAL-th
+ * record is kept in memory; a lookup binary searches these samples and then
+ * scans at most one interval of records, in each run from the newest to the
+ * oldest. Runs of similar size are merged, so that their number stays
+ * logarithmic in the number of records, and each record is only rewritten
+ * a logarithmic number of times. A store may be shared by a family of
+ * forked learners, so all public methods are synchronized.
+ */
+class ColdAnswerStore {
+public:
+	typedef std::vector<int32_t> Key;
+	typedef std::vector<std::pair<Key, jint> > Run;
+
+	static const size_t INDEX_INTERVAL = 64;
+
+	struct Stats {
+		Stats(void) : spills(0), lookups(0), hits(0) {}
+
+		jlong spills; // number of runs written
+		jlong lookups;
+		jlong hits;
+	};
+
+public:
+	// The run files are named after the given path, and removed with the store
+	explicit ColdAnswerStore(const std::string &path);
+	~ColdAnswerStore(void);
+
+	/*
+	 * Writes the given run, which is sorted in place, as a new run file.
+	 * Answers in the run take precedence over stored ones for equal words.
+	 * Returns false if the file could not be written, in which case the
+	 * previous contents remain available.
+	 */
+	bool spill(Run &run);
+
+	bool lookup(const Word &w, jint &answer);
+	// Like lookup, but not counted in the statistics
+	bool find(const Word &w, jint &answer);
+
+	// Number of records in all runs
+	jlong size(void) const;
+	jlong fileBytes(void) const;
+	Stats stats(void) const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_stats;
+	}
+
+private:
+	struct RunFile {
+		RunFile(void) : data(NULL), length(0), count(0), mapping(NULL) {}
+
+		std::string path;
+		const unsigned char *data;
+		size_t length;
+		uint64_t count;
+		std::vector<uint64_t> index;
+		void *mapping; // platform-specific mapping handle
+	};
+
+private:
+	bool findLocked(const Word &w, jint &answer);
+	bool findIn(const RunFile &file, const Key &key, jint &answer);
+	// Names a new run file; the file is written, then mapped
+	void newRunFile(RunFile &file);
+	bool writeRun(RunFile &file, const Run &run);
+	// Merges two adjacent runs, with the newer answers taking precedence
+	bool mergeRuns(const RunFile &older, const RunFile &newer, RunFile &merged);
+	void removeRunFile(RunFile &file);
+	static bool map(RunFile &file);
+	static void unmap(RunFile &file);
+	// Decodes the record at offset pos, returning the offset after it
+	static size_t decode(const RunFile &file, size_t pos, Key &key, jint &answer);
+
+private:
+	mutable std::mutex m_mutex;
+	std::string m_path;
+	std::vector<RunFile> m_runs; // from the oldest to the newest
+	uint64_t m_nextRun;
+	Stats m_stats;
+	Key m_scratch;
+};
+
+#endif // LEARNLIB_LIBALF_NATIVE_COLDANSWERSTORE_HPP
@@ -0,0 +1,134 @@
+/* Copyright (C) 2015 TU Dortmund
+ * This file is part of LearnLib, http://www.learnlib.de/.
+ * 
+ * LearnLib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 3.0 as published by the Free Software Foundation.
+ * 
+ * LearnLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with LearnLib; if not, see
+ * <http://www.gnu.de/documents/lgpl.en.html>.
+ */
+
+// ConjectureHandle.hpp
+// Conjectures handed out to the Java side by reference, so that summary
+// information can be queried and the encoding can be retrieved in parts,
+// on demand. A handle shares the immutable flat representation with the
+// learner, hence it stays valid after the learner advances or is disposed,
+// until it is released.
+
+#ifndef LEARNLIB_LIBALF_NATIVE_CONJECTUREHANDLE_HPP
+#define LEARNLIB_LIBALF_NATIVE_CONJECTUREHANDLE_HPP
+
+#include <memory>
+#include <vector>
+#include <cstddef>
+
+#include <jni.h>
+
+#include "FlatAutomaton.hpp"
+
+class ConjectureHandle {
+public:
+	// Encoding formats, with the values of the SAF automaton types
+	enum Format {
+		NATIVE_FORMAT = -1, // the format the conjecture is usually encoded in
+		DFA_FORMAT = 0,
+		NFA_FORMAT = 1,
+		MEALY_FORMAT = 2
+	};
+
+public:
+	virtual ~ConjectureHandle(void) {}
+
+	virtual Format nativeFormat(void) const = 0;
+	virtual int numStates(void) const = 0;
+	virtual int alphabetSize(void) const = 0;
+	// Number of defined transitions, or -1 if unknown
+	virtual jlong numTransitions(void) const = 0;
+
+	/*
+	 * Computes the size of the part of the encoding in the given format for
+	 * the states [begin, end), see SAF.hpp. Returns false if the format or
+	 * range is not supported.
+	 */
+	virtual bool computePartSize(Format format, int begin, int end, size_t &size) const = 0;
+	virtual bool encodePart(Format format, int begin, int end, jbyte *buf, size_t size) const = 0;
+
+protected:
+	bool validRange(int begin, int end) const
+	{
+		return (0 <= begin && begin <= end && end <= numStates());
+	}
+};
+
+/*
+ * Handle for DFA and NFA conjectures. Deterministic automata can also be
+ * encoded as NFAs.
+ */
+class FAConjectureHandle : public ConjectureHandle {
+public:
+	explicit FAConjectureHandle(const std::shared_ptr<const FlatAutomaton> &fa) : m_fa(fa) {}
+
+	virtual Format nativeFormat(void) const;
+	virtual int numStates(void) const { return m_fa->numStates(); }
+	virtual int alphabetSize(void) const { return m_fa->alphabetSize(); }
+	virtual jlong numTransitions(void) const;
+	virtual bool computePartSize(Format format, int begin, int end, size_t &size) const;
+	virtual bool encodePart(Format format, int begin, int end, jbyte *buf, size_t size) const;
+
+private:
+	// Returns the automaton in the representation for the given format, or NULL
+	const FlatAutomaton *view(Format format) const;
+
+private:
+	std::shared_ptr<const FlatAutomaton> m_fa;
+	mutable std::unique_ptr<FlatAutomaton> m_nfaView;
+};
+
+class MealyConjectureHandle : public ConjectureHandle {
+public:
+	explicit MealyConjectureHandle(const std::shared_ptr<const FlatMealyMachine> &mm) : m_mm(mm) {}
+
+	virtual Format nativeFormat(void) const { return MEALY_FORMAT; }
+	virtual int numStates(void) const { return m_mm->numStates(); }
+	virtual int alphabetSize(void) const { return m_mm->alphabetSize(); }
+	virtual jlong numTransitions(void) const;
+	virtual bool computePartSize(Format format, int begin, int end, size_t &size) const;
+	virtual bool encodePart(Format format, int begin, int end, jbyte *buf, size_t size) const;
+
+private:
+	std::shared_ptr<const FlatMealyMachine> m_mm;
+};
+
+/*
+ * Handle over a complete encoding, for learners without a native flat
+ * representation of their conjectures. Only the full encoding in the native
+ * format can be retrieved.
+ */
+class EncodedConjectureHandle : public ConjectureHandle {
+public:
+	// Takes over the contents of the given encoding
+	explicit EncodedConjectureHandle(std::vector<jbyte> &encoding);
+
+	virtual Format nativeFormat(void) const;
+	virtual int numStates(void) const;
+	virtual int alphabetSize(void) const;
+	virtual jlong numTransitions(void) const { return -1; }
+	virtual bool computePartSize(Format format, int begin, int end, size_t &size) const;
+	virtual bool encodePart(Format format, int begin, int end, jbyte *buf, size_t size) const;
+
+private:
+	bool isFull(Format format, int begin, int end) const;
+	jint readInt32(size_t pos) const;
+
+private:
+	std::vector<jbyte> m_encoding;
+};
+
+#endif // LEARNLIB_LIBALF_NATIVE_CONJECTUREHANDLE_HPP
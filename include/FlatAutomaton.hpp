@@ -0,0 +1,137 @@
+/* Copyright (C) 2015 TU Dortmund
+ * This file is part of LearnLib, http://www.learnlib.de/.
+ *
+ * LearnLib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 3.0 as published by the Free Software Foundation.
+ *
+ * LearnLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with LearnLib; if not, see
+ * <http://www.gnu.de/documents/lgpl.en.html>.
+ */
+
+// FlatAutomaton.hpp
+// Flat, array-based representation of finite automata. Conjectures are
+// converted into this representation once, and all further processing
+// (encoding, analyses) works on it.
+
+#ifndef LEARNLIB_LIBALF_NATIVE_FLATAUTOMATON_HPP
+#define LEARNLIB_LIBALF_NATIVE_FLATAUTOMATON_HPP
+
+#include <vector>
+#include <cstddef>
+#include <stdint.h>
+
+#include <libalf/conjecture.h>
+
+/*
+ * For deterministic automata, transitions are stored in a dense table with
+ * alphabetSize entries per state, where -1 denotes an undefined transition.
+ * For nondeterministic automata, transitions are stored in CSR form: the
+ * successors of state q on symbol a are
+ * targets[offsets[q*alphabetSize + a] .. offsets[q*alphabetSize + a + 1]).
+ * Acceptance is stored as a bitset, with state i corresponding to bit i%32
+ * of word i/32.
+ */
+class FlatAutomaton {
+public:
+	FlatAutomaton(const libalf::finite_automaton &fa, bool deterministic);
+	/*
+	 * Creates a deterministic automaton with the given initial state,
+	 * taking over the contents of the acceptance bitset and transition table.
+	 */
+	FlatAutomaton(int alphabetSize, int numStates, int initial,
+			std::vector<uint32_t> &acceptance, std::vector<int32_t> &table);
+
+	// Converts a deterministic automaton into the nondeterministic representation
+	void convertToNondeterministic(void);
+
+	bool isDeterministic(void) const { return m_deterministic; }
+	int alphabetSize(void) const { return m_alphabetSize; }
+	int numStates(void) const { return m_numStates; }
+
+	const std::vector<int32_t> &initialStates(void) const { return m_initial; }
+	const std::vector<uint32_t> &acceptance(void) const { return m_acceptance; }
+
+	bool isAccepting(int state) const
+	{
+		return (m_acceptance[state / 32] >> (state % 32)) & 1;
+	}
+
+	// deterministic automata only
+	const std::vector<int32_t> &table(void) const { return m_table; }
+	int successor(int state, int sym) const
+	{
+		return m_table[static_cast<size_t>(state) * m_alphabetSize + sym];
+	}
+
+	// nondeterministic automata only
+	const std::vector<int32_t> &offsets(void) const { return m_offsets; }
+	const std::vector<int32_t> &targets(void) const { return m_targets; }
+
+private:
+	void initDFATransitions(const libalf::finite_automaton &fa);
+	void initNFATransitions(const libalf::finite_automaton &fa);
+
+private:
+	bool m_deterministic;
+	int m_alphabetSize;
+	int m_numStates;
+	std::vector<int32_t> m_initial;
+	std::vector<uint32_t> m_acceptance;
+	std::vector<int32_t> m_table;
+	std::vector<int32_t> m_offsets;
+	std::vector<int32_t> m_targets;
+};
+
+/*
+ * Deterministic Mealy machine, with a dense transition table as for DFAs and
+ * a parallel table holding the output of each transition. Undefined
+ * transitions have target -1; their output is 0 and carries no meaning, so
+ * that every int is a valid output of a defined transition.
+ */
+class FlatMealyMachine {
+public:
+	/*
+	 * Converts a Moore machine that was learned from the last outputs of
+	 * words: the output of a transition is the output of its target state.
+	 * Transitions into states without an output are left undefined.
+	 */
+	explicit FlatMealyMachine(const libalf::moore_machine<int> &mm);
+	/*
+	 * Creates a Mealy machine with the given initial state, taking over the
+	 * contents of the transition and output tables.
+	 */
+	FlatMealyMachine(int alphabetSize, int numStates, int initial,
+			std::vector<int32_t> &table, std::vector<int32_t> &outputs);
+
+	int alphabetSize(void) const { return m_alphabetSize; }
+	int numStates(void) const { return m_numStates; }
+	int initialState(void) const { return m_initial; }
+
+	const std::vector<int32_t> &table(void) const { return m_table; }
+	const std::vector<int32_t> &outputs(void) const { return m_outputs; }
+
+	int successor(int state, int sym) const
+	{
+		return m_table[static_cast<size_t>(state) * m_alphabetSize + sym];
+	}
+	int output(int state, int sym) const
+	{
+		return m_outputs[static_cast<size_t>(state) * m_alphabetSize + sym];
+	}
+
+private:
+	int m_alphabetSize;
+	int m_numStates;
+	int m_initial;
+	std::vector<int32_t> m_table;
+	std::vector<int32_t> m_outputs;
+};
+
+#endif // LEARNLIB_LIBALF_NATIVE_FLATAUTOMATON_HPP
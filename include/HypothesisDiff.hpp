@@ -0,0 +1,62 @@
+/* Copyright (C) 2015 TU Dortmund
+ * This file is part of LearnLib, http://www.learnlib.de/.
+ * 
+ * LearnLib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 3.0 as published by the Free Software Foundation.
+ * 
+ * LearnLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with LearnLib; if not, see
+ * <http://www.gnu.de/documents/lgpl.en.html>.
+ */
+
+// HypothesisDiff.hpp
+// Computation of words distinguishing two successive hypotheses, via a
+// breadth-first exploration of their product automaton.
+
+#ifndef LEARNLIB_LIBALF_NATIVE_HYPOTHESISDIFF_HPP
+#define LEARNLIB_LIBALF_NATIVE_HYPOTHESISDIFF_HPP
+
+#include <jni.h>
+
+#include "FlatAutomaton.hpp"
+#include "QueryCursor.hpp"
+#include "Budget.hpp"
+
+namespace HypothesisDiff {
+
+enum Result {
+	OK,
+	UNAVAILABLE, // no previous hypothesis, or hypotheses of different kinds
+	TIMED_OUT
+};
+
+struct Stats {
+	Stats(void) : productStates(0), distinguishingStates(0) {}
+
+	jlong productStates; // discovered states of the product automaton
+	jlong distinguishingStates; // explored product states with differing acceptance
+};
+
+/*
+ * Explores the product of the hypotheses oldHyp and newHyp, which must be
+ * over the same alphabet. For every reachable product state in which the
+ * hypotheses disagree, in breadth-first order, its shortest access word is
+ * added to words. The first word is thus a shortest word in the symmetric
+ * difference. Exploration stops once maxWords words have been collected
+ * (0 means no limit), so the statistics only cover the whole reachable
+ * product if fewer words exist. Nondeterministic hypotheses are
+ * determinized on the fly. Returns UNAVAILABLE if only one of the
+ * hypotheses is deterministic.
+ */
+Result compare(const FlatAutomaton &oldHyp, const FlatAutomaton &newHyp, size_t maxWords,
+		QueryBatch &words, Stats &stats, const Budget *budget = NULL);
+
+};
+
+#endif // LEARNLIB_LIBALF_NATIVE_HYPOTHESISDIFF_HPP
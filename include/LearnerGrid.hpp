@@ -0,0 +1,123 @@
+/* Copyright (C) 2015 TU Dortmund
+ * This file is part of LearnLib, http://www.learnlib.de/.
+ * 
+ * LearnLib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 3.0 as published by the Free Software Foundation.
+ * 
+ * LearnLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with LearnLib; if not, see
+ * <http://www.gnu.de/documents/lgpl.en.html>.
+ */
+
+// LearnerGrid.hpp
+// A set of learners that are created from a compact specification and
+// driven concurrently, exchanging queries, answers and conjectures with the
+// Java side in bulk.
+
+#ifndef LEARNLIB_LIBALF_NATIVE_LEARNERGRID_HPP
+#define LEARNLIB_LIBALF_NATIVE_LEARNERGRID_HPP
+
+#include <vector>
+
+#include <jni.h>
+
+#include "LibAlf.hpp"
+#include "LibalfLearner.hpp"
+#include "MembershipOracle.hpp"
+
+class LearnerGrid {
+public:
+	enum Status {
+		NO_LEARNER = -1, // the learner could not be created
+		QUERIES = 0, // queries are pending, to be answered via processAnswers
+		CONJECTURE = 1, // a conjecture is available
+		TIMED_OUT = 2, // the budget of the learner has expired
+		STALLED = 3, // no conjecture could be derived, and no queries are pending
+		READY = 4 // the learner is to be advanced (internal)
+	};
+
+	struct Stats {
+		Stats(void) : rounds(0), queries(0), conjectures(0), advanceNanos(0) {}
+
+		jlong rounds;
+		jlong queries;
+		jlong conjectures;
+		jlong advanceNanos;
+	};
+
+	static const size_t NUM_STATS = 4;
+
+public:
+	/*
+	 * Creates learners according to the given specification, which consists
+	 * of the number of learners, followed by the algorithm ID, alphabet
+	 * size, number of options and the options themselves for each learner.
+	 */
+	LearnerGrid(const LibAlf &libalf, size_t specLen, const jint *spec);
+	~LearnerGrid(void);
+
+	size_t size(void) const { return m_entries.size(); }
+	Status status(size_t i) const { return m_entries[i].status; }
+	const Stats &stats(size_t i) const { return m_entries[i].stats; }
+	const std::vector<jbyte> &conjecture(size_t i) const { return m_entries[i].conjecture; }
+
+	/*
+	 * Sets the oracle answering the queries of the given learner natively.
+	 * The oracle is not owned by the grid, and must outlive it.
+	 */
+	bool setOracle(size_t i, MembershipOracle *oracle);
+
+	/*
+	 * Advances all learners that are not waiting for answers or a
+	 * counterexample, using the shared thread pool.
+	 */
+	void advanceAll(void);
+
+	/*
+	 * Pending queries are encoded as the number of learners with pending
+	 * queries, followed by the index of each such learner and its encoded
+	 * query batch.
+	 */
+	size_t computeQueriesSize(void) const;
+	void encodeQueries(jint *buf) const;
+
+	/*
+	 * Processes the answers to all pending queries, in the order in which
+	 * they were encoded.
+	 */
+	bool processAnswers(size_t numAnswers, const jint *answers);
+
+	/*
+	 * Counterexamples are encoded as their number, followed by the index of
+	 * the learner and the encoded word for each counterexample. Several
+	 * counterexamples for the same learner are added in the given order.
+	 */
+	bool addCounterExamples(size_t encLen, const jint *enc);
+
+private:
+	struct Entry {
+		Entry(void) : learner(NULL), oracle(NULL), pending(NULL), status(NO_LEARNER) {}
+
+		LibalfLearner *learner;
+		MembershipOracle *oracle;
+		QueryBatch *pending;
+		Status status;
+		Stats stats;
+		std::vector<jbyte> conjecture;
+	};
+
+private:
+	void advance(Entry &entry);
+	void encodeConjecture(Entry &entry);
+
+private:
+	std::vector<Entry> m_entries;
+};
+
+#endif // LEARNLIB_LIBALF_NATIVE_LEARNERGRID_HPP
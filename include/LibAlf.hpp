@@ -24,9 +24,14 @@
 #define LEARNLIB_LIBALF_NATIVE_LIBALF_HPP
 
 #include <jni.h>
+#include <list>
 #include <vector>
+#include <string>
+#include <memory>
+#include <stdint.h>
 
 class LibalfLearner;
+class RemoteConnection;
 
 typedef LibalfLearner *LearnerInit(jint alphabetSize, size_t otherOptsLen, jint *otherOptions);
 
@@ -35,10 +40,28 @@ class LibAlf {
 
 public:
 	LibAlf(JNIEnv *env, jobjectArray algIds);
+	explicit LibAlf(const std::vector<std::string> &algNames);
+	~LibAlf(void);
+
+	/*
+	 * Switches this session to thin client mode, where learners are hosted
+	 * by the learner daemon listening on the given socket.
+	 */
+	bool connectRemote(const char *socketPath);
+
 	LibalfLearner *createLearner(jint algorithmId, jint alphabetSize, size_t otherOptsLen, jint *otherOptions) const;
 
+	// The algorithm ID must be valid
+	const std::string &algorithmName(jint algorithmId) const { return m_algNames[algorithmId]; }
+
+private:
+	void initAlgorithms(void);
+
 private:
+	std::vector<std::string> m_algNames;
 	std::vector<LearnerInit *> m_inits;
+	std::shared_ptr<RemoteConnection> m_remote;
+	uint64_t m_remoteId;
 	std::list<LibAlf *>::iterator m_ref;
 };
 
@@ -24,30 +24,213 @@
 #define LEARNLIB_LIBALF_NATIVE_LIBALFLEARNER_HPP
 
 #include <list>
+#include <vector>
+#include <string>
+#include <memory>
+#include <chrono>
+#include <algorithm>
 
 #include <jni.h>
 
 #include "SAF.hpp"
+#include "FlatAutomaton.hpp"
+#include "CEShortening.hpp"
+#include "Budget.hpp"
+#include "QueryCursor.hpp"
+#include "AnswerCache.hpp"
+#include "HypothesisDiff.hpp"
+#include "ColdAnswerStore.hpp"
+#include "SessionLog.hpp"
+#include "Minimization.hpp"
+#include "WordCodec.hpp"
+#include "PackedCodec.hpp"
+#include "ConjectureHandle.hpp"
+#include "ScratchWord.hpp"
 
 #include <libalf/learning_algorithm.h>
 #include <libalf/conjecture.h>
-
-typedef std::list<int> Word;
-typedef std::list<Word> QueryBatch;
+#include <libalf/serialize.h>
 
 class LibalfLearner {
 public:
-	LibalfLearner(void) {}
-	virtual ~LibalfLearner(void) {}
+	LibalfLearner(void) : m_recorder(NULL) {}
+	virtual ~LibalfLearner(void)
+	{
+		delete m_recorder;
+	}
 
-	virtual const libalf::conjecture *advance(void) = 0;
+	// Returns true if a new conjecture has been derived
+	virtual bool advance(void) = 0;
 	virtual QueryBatch *getQueries(void) = 0;
+	// Opens a cursor over the pending queries, see QueryCursor
+	virtual QueryCursor *openQueryCursor(void) { return new BatchQueryCursor(getQueries()); }
 	virtual void addCounterExample(Word &ce) = 0;
 	virtual bool addEncodedAnswer(Word &w, jint answer) = 0;
-	virtual size_t computeConjectureSize(const libalf::conjecture &cj) const = 0;
-	virtual void encodeConjecture(jbyte *buf, size_t size, const libalf::conjecture &cj) const = 0;
+
+	/*
+	 * Adds the answers to all words of the batch. Returns false if any of
+	 * them conflicts with the knowledge of the learner; the others are
+	 * added nonetheless.
+	 */
+	virtual bool addEncodedAnswers(QueryBatch &batch, const jint *answers)
+	{
+		bool ok = true;
+		for (QueryBatch::iterator it = batch.begin(); it != batch.end(); ++it) {
+			ok &= addEncodedAnswer(*it, *answers++);
+		}
+		return ok;
+	}
+
+	/*
+	 * Adds numSamples samples, encoded in [samplesEnc, samplesEnd) as by
+	 * WordCodec::encodeWord, with the given outputs. Stops at the first
+	 * sample that is truncated or conflicts with the knowledge of the
+	 * learner, and returns the number of samples added before it.
+	 */
+	virtual size_t addEncodedSamples(size_t numSamples, const jint *samplesEnc, const jint *samplesEnd, const jint *outputs) = 0;
+
+	/*
+	 * Adds a batch of decoded samples, as by addEncodedSamples. By default,
+	 * the batch is encoded and passed to addEncodedSamples.
+	 */
+	virtual size_t addSamples(const QueryBatch &samples, const jint *outputs)
+	{
+		std::vector<jint> enc(WordCodec::encodedBatchSize(samples));
+		WordCodec::encodeBatch(enc.data(), samples);
+		return addEncodedSamples(samples.size(), enc.data() + 1, enc.data() + enc.size(), outputs);
+	}
+
+	/*
+	 * Adds numSamples samples, encoded in [samplesEnc, samplesEnd) as the
+	 * words of a packed batch with the given lane width, with the boolean
+	 * outputs packed into the bitmap (see PackedCodec.hpp). Stops as
+	 * addEncodedSamples does. By default, the samples are decoded into a
+	 * batch and passed to addSamples.
+	 */
+	virtual size_t addPackedSamples(size_t numSamples, const unsigned char *samplesEnc, const unsigned char *samplesEnd,
+			int laneBytes, const unsigned char *bitmap)
+	{
+		QueryBatch samples;
+		const unsigned char *p = samplesEnc;
+		for (size_t i = 0; i < numSamples; i++) {
+			samples.push_back(Word());
+			p = PackedCodec::decodeWord(p, samplesEnd, laneBytes, samples.back());
+			if (!p) {
+				samples.pop_back();
+				break;
+			}
+		}
+		std::vector<jint> outputs(samples.size());
+		PackedCodec::unpackAnswers(bitmap, samples.size(), outputs.data());
+		return addSamples(samples, outputs.data());
+	}
+
+	// Returns true if answers are booleans, as required by the packed encodings
+	virtual bool booleanAnswers(void) const = 0;
+
+	// Returns true if a conjecture has been derived, which is then the current one
+	virtual bool hasConjecture(void) const = 0;
+	virtual size_t computeConjectureSize(void) const = 0;
+	// Returns false if encoding was interrupted because the budget expired
+	virtual bool encodeConjecture(jbyte *buf, size_t size) const = 0;
+
+	/*
+	 * Returns a handle to the current conjecture, or NULL if there is none.
+	 * By default, the handle holds the complete encoding, which is NULL if
+	 * encoding was interrupted because the budget expired.
+	 */
+	virtual ConjectureHandle *openConjecture(void) const
+	{
+		std::vector<jbyte> encoding(computeConjectureSize());
+		if (encoding.empty() || !encodeConjecture(encoding.data(), encoding.size())) {
+			return NULL;
+		}
+		return new EncodedConjectureHandle(encoding);
+	}
+
+	// Returns false if counterexample shortening is not supported by this learner.
+	// Only the DFA learners support it; NL* and the Mealy learners do not.
+	virtual bool setCounterExampleShortening(bool enable) { return false; }
+	virtual const CEShortening::Stats *getCounterExampleStats(void) const { return NULL; }
+
+	/*
+	 * Returns an independent copy of this learner, including its knowledge
+	 * and algorithm state, or NULL if forking is not supported. Answers
+	 * added to any learner of a fork family are shared with all others.
+	 */
+	virtual LibalfLearner *fork(void) { return NULL; }
+
+	/*
+	 * Enables spilling of the knowledgebase into a cold tier stored in files
+	 * named after the given path, whenever it holds more than maxHotAnswers
+	 * answers that are not in the cold tier yet. Returns
+	 * false if spilling is not supported by this learner. Passive learners
+	 * do not support it, as their algorithms read the samples from the
+	 * knowledgebase and never request them again.
+	 */
+	virtual bool enableSpill(const char *path, jlong maxHotAnswers) { return false; }
+	virtual const ColdAnswerStore *coldAnswers(void) const { return NULL; }
+
+	/*
+	 * Enables post-processing of conjectures before they are returned:
+	 * minimization, and checking them against the answers in the
+	 * knowledgebase. Returns false if not supported by this learner.
+	 */
+	virtual bool setPostProcessing(bool minimize, bool verify) { return false; }
+	virtual const Minimization::Stats *getPostProcessStats(void) const { return NULL; }
+
+	// Returns the current hypothesis, or NULL if it is not available natively
+	virtual const FlatAutomaton *hypothesis(void) const { return NULL; }
+
+	/*
+	 * Compares the current hypothesis to the previous one, see
+	 * HypothesisDiff::compare. Returns UNAVAILABLE if there is no previous
+	 * hypothesis.
+	 */
+	virtual HypothesisDiff::Result diffHypotheses(size_t maxWords, QueryBatch &words, HypothesisDiff::Stats &stats) const
+	{
+		return HypothesisDiff::UNAVAILABLE;
+	}
+	virtual const AnswerCache *answerCache(void) const { return NULL; }
+
+	Budget &budget(void) { return m_budget; }
+	const Budget &budget(void) const { return m_budget; }
+	// Requests cancellation of the operation in progress; may be called from any thread
+	virtual void cancel(void) { m_budget.cancel(); }
+
+	// Reusable word for decoding words from JNI buffers
+	ScratchWord &scratchWord(void) { return m_scratch; }
+
+	// Records the calls made to this learner across the JNI boundary, if set
+	SessionLog::Recorder *recorder(void) { return m_recorder; }
+	void setRecorder(SessionLog::Recorder *recorder)
+	{
+		delete m_recorder;
+		m_recorder = recorder;
+	}
+
+private:
+	Budget m_budget;
+	SessionLog::Recorder *m_recorder;
+	ScratchWord m_scratch;
 };
 
+/*
+ * Reports an expired budget to the Java side as an empty byte array, which
+ * cannot be confused with a valid SAF encoding. A pending cancellation
+ * request is cleared once it has been reported.
+ */
+jbyteArray createTimedOutArray(JNIEnv *env, LibalfLearner &learner);
+
+/*
+ * Encodes the current conjecture of the learner into a new byte array, or
+ * reports an expired budget as above. The conjecture is not lost if its
+ * encoding is interrupted; it stays the current one until the next
+ * conjecture is derived.
+ */
+jbyteArray createConjectureArray(JNIEnv *env, LibalfLearner &learner);
+
+
 
 template<class A, class D>
 class TypedLibalfLearner : public LibalfLearner {
@@ -55,10 +238,77 @@ public:
 	typedef libalf::learning_algorithm<A> LibalfAlgoBase;
 
 public:
+	TypedLibalfLearner(void) : m_maxHotAnswers(0), m_coldResolved(0) {}
+
+	// Answers are only shared with the fork family once they are accepted
 	virtual bool addEncodedAnswer(Word &w, jint answer)
 	{
-		A answerDec = static_cast<D *>(this)->decodeAnswer(answer);
-		return m_kb.add_knowledge(w, answerDec);
+		if (!addKnowledge(w, answer)) {
+			return false;
+		}
+		if (m_answerCache) {
+			m_answerCache->store(w, answer);
+		}
+		return true;
+	}
+
+	// A batch containing a conflicting answer is not shared at all
+	virtual bool addEncodedAnswers(QueryBatch &batch, const jint *answers)
+	{
+		bool ok = true;
+		const jint *answer = answers;
+		for (QueryBatch::iterator it = batch.begin(); it != batch.end(); ++it) {
+			ok &= addKnowledge(*it, *answer++);
+		}
+		if (m_answerCache && ok) {
+			m_answerCache->storeAll(batch, answers);
+		}
+		return ok;
+	}
+
+	// Samples are decoded into the scratch word and added without a virtual call per sample
+	virtual size_t addEncodedSamples(size_t numSamples, const jint *samplesEnc, const jint *samplesEnd, const jint *outputs)
+	{
+		ScratchWord &scratch = this->scratchWord();
+		const jint *p = samplesEnc;
+		for (size_t i = 0; i < numSamples; i++) {
+			const jint *sampleEnd = WordCodec::skipWord(p, samplesEnd);
+			if (!sampleEnd) {
+				return i;
+			}
+			scratch.assign(p + 1, sampleEnd);
+			if (!addSample(scratch.word(), outputs[i])) {
+				return i;
+			}
+			p = sampleEnd;
+		}
+		return numSamples;
+	}
+
+	virtual size_t addSamples(const QueryBatch &samples, const jint *outputs)
+	{
+		size_t added = 0;
+		for (QueryBatch::const_iterator it = samples.begin(); it != samples.end(); ++it) {
+			if (!addSample(*it, outputs[added])) {
+				break;
+			}
+			added++;
+		}
+		return added;
+	}
+
+	virtual size_t addPackedSamples(size_t numSamples, const unsigned char *samplesEnc, const unsigned char *samplesEnd,
+			int laneBytes, const unsigned char *bitmap)
+	{
+		ScratchWord &scratch = this->scratchWord();
+		const unsigned char *p = samplesEnc;
+		for (size_t i = 0; i < numSamples; i++) {
+			p = PackedCodec::decodeWord(p, samplesEnd, laneBytes, scratch);
+			if (!p || !addSample(scratch.word(), PackedCodec::answerBit(bitmap, i) ? 1 : 0)) {
+				return i;
+			}
+		}
+		return numSamples;
 	}
 
 	virtual QueryBatch *getQueries(void)
@@ -66,9 +316,87 @@ public:
 		return new QueryBatch(m_kb.get_queries());
 	}
 
-	virtual const libalf::conjecture *advance(void)
+	virtual QueryCursor *openQueryCursor(void)
+	{
+		return new KnowledgebaseQueryCursor<A>(m_kb);
+	}
+
+	/*
+	 * libalf offers no way to share state between learners, so the
+	 * knowledgebase and algorithm state are copied via their serialized
+	 * forms. Answers given afterwards are shared via the answer cache, and
+	 * the cold tier, if any, is shared by the whole family.
+	 */
+	virtual LibalfLearner *fork(void)
+	{
+		D *self = static_cast<D *>(this);
+		D *clone = self->createSibling();
+		TypedLibalfLearner *typedClone = clone;
+
+		std::basic_string<int32_t> kbSerial = m_kb.serialize();
+		libalf::serial_stretch kbStretch(kbSerial);
+		std::basic_string<int32_t> algSerial = self->m_algorithm.serialize();
+		libalf::serial_stretch algStretch(algSerial);
+		if (!typedClone->m_kb.deserialize(kbStretch) || !clone->m_algorithm.deserialize(algStretch)) {
+			delete clone;
+			return NULL;
+		}
+		clone->copyForkState(*self);
+		typedClone->m_coldStore = m_coldStore;
+		typedClone->m_maxHotAnswers = m_maxHotAnswers;
+		typedClone->m_coldResolved = m_coldResolved;
+
+		if (!m_answerCache) {
+			m_answerCache = std::make_shared<AnswerCache>();
+		}
+		typedClone->m_answerCache = m_answerCache;
+		return clone;
+	}
+
+	virtual const AnswerCache *answerCache(void) const
+	{
+		return m_answerCache.get();
+	}
+
+	virtual bool enableSpill(const char *path, jlong maxHotAnswers)
+	{
+		if (!D::ACTIVE || m_coldStore || maxHotAnswers <= 0) {
+			return false;
+		}
+		m_coldStore = std::make_shared<ColdAnswerStore>(path);
+		m_maxHotAnswers = static_cast<size_t>(maxHotAnswers);
+		return true;
+	}
+
+	virtual const ColdAnswerStore *coldAnswers(void) const
 	{
-		return static_cast<D *>(this)->m_algorithm.advance();
+		return m_coldStore.get();
+	}
+
+	/*
+	 * Pending queries that can be answered from the answers shared by the
+	 * fork family or from the cold tier are resolved here, and the algorithm
+	 * is advanced again, so they are never handed out. The budget is checked
+	 * between these rounds; if it expires, false is returned and the resolved
+	 * answers are kept.
+	 */
+	virtual bool advance(void)
+	{
+		D *self = static_cast<D *>(this);
+		if (m_coldStore && hotAnswers() > m_maxHotAnswers) {
+			spillAnswers();
+		}
+		for (;;) {
+			libalf::conjecture *cj = self->m_algorithm.advance();
+			if (cj) {
+				self->storeConjecture(*cj);
+				delete cj;
+				return true;
+			}
+			if (!resolveKnownQueries() || this->budget().expired()) {
+				return false;
+			}
+		}
 	}
 
 	virtual void addCounterExample(Word &ce)
@@ -78,57 +406,386 @@ public:
 
 public:
 	// A decodeAnswer(jint encAnswer) const;
+	// jint encodeAnswer(A answer) const;
+	// void storeConjecture(const libalf::conjecture &cj);
+	// D *createSibling(void) const;
+	// void copyForkState(const D &other);
+	// static const bool ACTIVE;
+
+private:
+	/*
+	 * Spilled answers are no longer in the knowledgebase, so answers are
+	 * checked against the cold tier before they are added.
+	 */
+	bool addKnowledge(const Word &w, jint answer)
+	{
+		D *self = static_cast<D *>(this);
+		jint spilled;
+		if (m_coldStore && m_coldStore->find(w, spilled)
+				&& self->decodeAnswer(spilled) != self->decodeAnswer(answer)) {
+			return false;
+		}
+		return m_kb.add_knowledge(w, self->decodeAnswer(answer));
+	}
+
+	// As addEncodedAnswer, without the virtual call
+	bool addSample(const Word &w, jint output)
+	{
+		if (!addKnowledge(w, output)) {
+			return false;
+		}
+		if (m_answerCache) {
+			m_answerCache->store(w, output);
+		}
+		return true;
+	}
+
+	// Returns true if at least one pending query could be resolved
+	bool resolveKnownQueries(void)
+	{
+		if (!m_answerCache && !m_coldStore) {
+			return false;
+		}
+		D *self = static_cast<D *>(this);
+		std::list<std::list<int> > queries = m_kb.get_queries();
+		bool resolved = false;
+		for (std::list<std::list<int> >::iterator it = queries.begin(); it != queries.end(); ++it) {
+			jint answer;
+			if (m_answerCache && m_answerCache->lookup(*it, answer)) {
+				m_kb.add_knowledge(*it, self->decodeAnswer(answer));
+				resolved = true;
+			}
+			else if (m_coldStore && m_coldStore->lookup(*it, answer)) {
+				m_kb.add_knowledge(*it, self->decodeAnswer(answer));
+				m_coldResolved++;
+				resolved = true;
+			}
+		}
+		return resolved;
+	}
+
+	// Answers in the knowledgebase that were not taken from the cold tier
+	size_t hotAnswers(void) const
+	{
+		size_t answers = static_cast<size_t>(m_kb.count_answers());
+		return (answers > m_coldResolved) ? answers - m_coldResolved : 0;
+	}
+
+	/*
+	 * Moves all answers from the knowledgebase into the cold tier. For the
+	 * active libalf algorithms, the knowledgebase is only a cache of
+	 * answers: they re-request any answer they still need as a query, which
+	 * is then resolved from the cold tier, so it can be cleared afterwards.
+	 * Pending queries are re-requested the same way. Passive algorithms do
+	 * not, which is why they cannot enable spilling. Answers that are
+	 * already in the cold tier, in particular those resolved from it, are
+	 * not written again.
+	 */
+	void spillAnswers(void)
+	{
+		D *self = static_cast<D *>(this);
+		ColdAnswerStore::Run run;
+		run.reserve(hotAnswers());
+		for (typename libalf::knowledgebase<A>::iterator it = m_kb.begin(); it != m_kb.end(); ++it) {
+			if (!it->is_answered()) {
+				continue;
+			}
+			std::list<int> w = it->get_word();
+			jint spilled;
+			if (m_coldStore->find(w, spilled)) {
+				continue;
+			}
+			run.push_back(std::make_pair(ColdAnswerStore::Key(w.begin(), w.end()), self->encodeAnswer(it->get_answer())));
+		}
+		if (m_coldStore->spill(run)) {
+			m_kb.clear();
+			m_coldResolved = 0;
+		}
+	}
 
 protected:
 	libalf::knowledgebase<A> m_kb;
 	// LibalfAlgoBase m_algorithm;
+
+private:
+	std::shared_ptr<AnswerCache> m_answerCache;
+	std::shared_ptr<ColdAnswerStore> m_coldStore;
+	size_t m_maxHotAnswers;
+	// Answers in the knowledgebase that were resolved from the cold tier
+	size_t m_coldResolved;
 };
 
 template<class D>
 class LibalfFALearner : public TypedLibalfLearner<bool,D> {
 public:
-	size_t computeConjectureSize(const libalf::conjecture &cj) const
+	LibalfFALearner(void) : m_minimize(false), m_verify(false) {}
+
+	bool booleanAnswers(void) const
 	{
-		const libalf::finite_automaton &fa = dynamic_cast<const libalf::finite_automaton &>(cj);
-		return static_cast<const D *>(this)->computeFAConjectureSize(fa);
+		return true;
 	}
 
-	void encodeConjecture(jbyte *buf, size_t size, const libalf::conjecture &cj) const
+	bool hasConjecture(void) const
 	{
-		const libalf::finite_automaton &fa = dynamic_cast<const libalf::finite_automaton &>(cj);
-		return static_cast<const D *>(this)->encodeFAConjecture(buf, size, fa);
+		return (m_hypothesis != NULL);
+	}
+
+	size_t computeConjectureSize(void) const
+	{
+		return static_cast<const D *>(this)->computeFAConjectureSize(*m_hypothesis);
+	}
+
+	bool encodeConjecture(jbyte *buf, size_t size) const
+	{
+		return static_cast<const D *>(this)->encodeFAConjecture(buf, size, *m_hypothesis);
+	}
+
+	virtual ConjectureHandle *openConjecture(void) const
+	{
+		return m_hypothesis ? new FAConjectureHandle(m_hypothesis) : NULL;
+	}
+
+	virtual HypothesisDiff::Result diffHypotheses(size_t maxWords, QueryBatch &words, HypothesisDiff::Stats &stats) const
+	{
+		if (!m_previous || !m_hypothesis) {
+			return HypothesisDiff::UNAVAILABLE;
+		}
+		return HypothesisDiff::compare(*m_previous, *m_hypothesis, maxWords, words, stats, &this->budget());
+	}
+
+	virtual bool setPostProcessing(bool minimize, bool verify)
+	{
+		m_minimize = minimize;
+		m_verify = verify;
+		return true;
+	}
+
+	virtual const Minimization::Stats *getPostProcessStats(void) const
+	{
+		return &m_ppStats;
 	}
 
 public:
 	bool decodeAnswer(jint encAnswer) const { return (encAnswer); }
-	// size_t computeFAConjectureSize(const libalf::finite_automaton &fa) const;
-	// void encodeFAConjecture(jbyte *buf, size_t len, const libalf::finite_automaton &fa) const;
+	jint encodeAnswer(bool answer) const { return answer ? 1 : 0; }
+
+	/*
+	 * Converts the conjecture into the flat representation, which is kept as
+	 * the current hypothesis until the next conjecture is derived. The
+	 * hypothesis it replaces is kept for diffHypotheses. Hypotheses are
+	 * immutable, and may be shared with forks and conjecture handles.
+	 */
+	void storeConjecture(const libalf::conjecture &cj)
+	{
+		const libalf::finite_automaton &fa = dynamic_cast<const libalf::finite_automaton &>(cj);
+		m_previous = m_hypothesis;
+		m_hypothesis.reset(postProcess(new FlatAutomaton(fa, D::DETERMINISTIC)));
+	}
+
+	const FlatAutomaton *hypothesis(void) const { return m_hypothesis.get(); }
+
+	void copyForkState(const D &other)
+	{
+		const LibalfFALearner &o = other;
+		m_hypothesis = o.m_hypothesis;
+		m_previous = o.m_previous;
+		m_minimize = o.m_minimize;
+		m_verify = o.m_verify;
+	}
+
+	// size_t computeFAConjectureSize(const FlatAutomaton &fa) const;
+	// bool encodeFAConjecture(jbyte *buf, size_t len, const FlatAutomaton &fa) const;
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	// Bound on the number of states of determinized NFAs
+	enum { MIN_DETERMINIZATION_BOUND = 1024, DETERMINIZATION_FACTOR = 8 };
+
+	static jlong elapsedNanos(Clock::time_point start)
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+	}
+
+	/*
+	 * Replaces the hypothesis by its minimal DFA if that has fewer states.
+	 * NFAs are determinized first, as long as the subset construction stays
+	 * within a bound relative to their size, and the result is kept in the
+	 * nondeterministic representation so the SAF encoding does not change.
+	 * Verification only reports inconsistencies; answers in the cold tier
+	 * are not checked.
+	 */
+	FlatAutomaton *postProcess(FlatAutomaton *hyp)
+	{
+		if (m_minimize) {
+			Clock::time_point start = Clock::now();
+			FlatAutomaton *min = NULL;
+			if (hyp->isDeterministic()) {
+				min = Minimization::minimizeDFA(*hyp, false, &this->budget());
+			}
+			else {
+				size_t maxStates = std::max<size_t>(static_cast<size_t>(MIN_DETERMINIZATION_BOUND),
+						static_cast<size_t>(hyp->numStates()) * DETERMINIZATION_FACTOR);
+				FlatAutomaton *det = Minimization::determinize(*hyp, maxStates, &this->budget());
+				if (det) {
+					min = Minimization::minimizeDFA(*det, true, &this->budget());
+					delete det;
+				}
+				if (min) {
+					min->convertToNondeterministic();
+				}
+			}
+			m_ppStats.conjectures++;
+			m_ppStats.statesIn += hyp->numStates();
+			if (min && min->numStates() < hyp->numStates()) {
+				delete hyp;
+				hyp = min;
+				m_ppStats.minimized++;
+			}
+			else {
+				delete min;
+			}
+			m_ppStats.statesOut += hyp->numStates();
+			m_ppStats.minimizeNanos += elapsedNanos(start);
+		}
+		if (m_verify) {
+			Clock::time_point start = Clock::now();
+			size_t checked = 0;
+			m_ppStats.inconsistencies += Minimization::checkConsistency(*hyp, this->m_kb, checked);
+			m_ppStats.checkedAnswers += checked;
+			m_ppStats.checkNanos += elapsedNanos(start);
+		}
+		return hyp;
+	}
+
+private:
+	std::shared_ptr<const FlatAutomaton> m_hypothesis;
+	std::shared_ptr<const FlatAutomaton> m_previous;
+	bool m_minimize;
+	bool m_verify;
+	Minimization::Stats m_ppStats;
 };
 
 template<class D>
 class LibalfDFALearner : public LibalfFALearner<D> {
 public:
-	size_t computeFAConjectureSize(const libalf::finite_automaton &fa) const
+	static const bool DETERMINISTIC = true;
+
+public:
+	LibalfDFALearner(void) : m_shortenCEs(false) {}
+
+	virtual bool setCounterExampleShortening(bool enable)
+	{
+		m_shortenCEs = enable;
+		return true;
+	}
+
+	virtual const CEShortening::Stats *getCounterExampleStats(void) const
+	{
+		return &m_ceStats;
+	}
+
+	virtual void addCounterExample(Word &ce)
+	{
+		const FlatAutomaton *hyp = this->hypothesis();
+		if (m_shortenCEs && hyp) {
+			CEShortening::shortenDFA(ce, *hyp, this->m_kb, m_ceStats);
+		}
+		LibalfFALearner<D>::addCounterExample(ce);
+	}
+
+	void copyForkState(const D &other)
+	{
+		const LibalfDFALearner &o = other;
+		LibalfFALearner<D>::copyForkState(other);
+		m_shortenCEs = o.m_shortenCEs;
+	}
+
+	size_t computeFAConjectureSize(const FlatAutomaton &fa) const
 	{
 		return SAF::computeDFASize(fa);
 	}
-	void encodeFAConjecture(jbyte *buf, size_t size, const libalf::finite_automaton &fa) const
+	bool encodeFAConjecture(jbyte *buf, size_t size, const FlatAutomaton &fa) const
 	{
-		return SAF::encodeDFA(buf, size, fa);
+		return SAF::encodeDFA(buf, size, fa, &this->budget());
 	}
+
+private:
+	bool m_shortenCEs;
+	CEShortening::Stats m_ceStats;
 };
 
 template<class D>
 class LibalfNFALearner : public LibalfFALearner<D> {
 public:
-	size_t computeFAConjectureSize(const libalf::finite_automaton &fa) const
+	static const bool DETERMINISTIC = false;
+
+public:
+	size_t computeFAConjectureSize(const FlatAutomaton &fa) const
 	{
 		return SAF::computeNFASize(fa);
 	}
-	void encodeFAConjecture(jbyte *buf, size_t size, const libalf::finite_automaton &fa) const
+	bool encodeFAConjecture(jbyte *buf, size_t size, const FlatAutomaton &fa) const
+	{
+		return SAF::encodeNFA(buf, size, fa, &this->budget());
+	}
+};
+
+/*
+ * Learners for Mealy machines, based on libalf algorithms that learn Moore
+ * machines over integer outputs. The answer to a query is the output of the
+ * last symbol of the word (the empty word may be answered with any fixed
+ * value), so that the output of a transition is the output of the state it
+ * leads to. The converted conjecture is minimized, as Mealy equivalence is
+ * coarser than Moore equivalence.
+ */
+template<class D>
+class LibalfMealyLearner : public TypedLibalfLearner<int,D> {
+public:
+	bool booleanAnswers(void) const
+	{
+		return false;
+	}
+
+	bool hasConjecture(void) const
+	{
+		return (m_hypothesis != NULL);
+	}
+
+	size_t computeConjectureSize(void) const
 	{
-		return SAF::encodeNFA(buf, size, fa);
+		return SAF::computeMealySize(*m_hypothesis);
 	}
+
+	bool encodeConjecture(jbyte *buf, size_t size) const
+	{
+		return SAF::encodeMealy(buf, size, *m_hypothesis, &this->budget());
+	}
+
+	virtual ConjectureHandle *openConjecture(void) const
+	{
+		return m_hypothesis ? new MealyConjectureHandle(m_hypothesis) : NULL;
+	}
+
+public:
+	int decodeAnswer(jint encAnswer) const { return encAnswer; }
+	jint encodeAnswer(int answer) const { return answer; }
+
+	void storeConjecture(const libalf::conjecture &cj)
+	{
+		const libalf::moore_machine<int> &mm = dynamic_cast<const libalf::moore_machine<int> &>(cj);
+		FlatMealyMachine flat(mm);
+		m_hypothesis.reset(Minimization::minimizeMealy(flat));
+	}
+
+	void copyForkState(const D &other)
+	{
+		const LibalfMealyLearner &o = other;
+		m_hypothesis = o.m_hypothesis;
+	}
+
+private:
+	std::shared_ptr<const FlatMealyMachine> m_hypothesis;
 };
 
 
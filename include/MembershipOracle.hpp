@@ -0,0 +1,54 @@
+/* Copyright (C) 2015 TU Dortmund
+ * This file is part of LearnLib, http://www.learnlib.de/.
+ * 
+ * LearnLib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 3.0 as published by the Free Software Foundation.
+ * 
+ * LearnLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with LearnLib; if not, see
+ * <http://www.gnu.de/documents/lgpl.en.html>.
+ */
+
+// MembershipOracle.hpp
+// Interface for native sources of membership query answers, which allow
+// learners to be driven without a round trip to the Java side.
+
+#ifndef LEARNLIB_LIBALF_NATIVE_MEMBERSHIPORACLE_HPP
+#define LEARNLIB_LIBALF_NATIVE_MEMBERSHIPORACLE_HPP
+
+#include <vector>
+
+#include <jni.h>
+
+#include "LibalfLearner.hpp"
+
+class MembershipOracle {
+public:
+	virtual ~MembershipOracle(void) {}
+
+	/*
+	 * Answers all queries in the batch, storing the encoded answers in the
+	 * order of the batch. Implementations must allow concurrent calls from
+	 * several threads.
+	 */
+	virtual void answerQueries(const QueryBatch &batch, jint *answers) = 0;
+
+	/*
+	 * Answers all queries in the batch, and adds the answers to the
+	 * knowledge of the learner.
+	 */
+	void processQueries(LibalfLearner &learner, QueryBatch &batch)
+	{
+		std::vector<jint> answers(batch.size());
+		answerQueries(batch, answers.data());
+		learner.addEncodedAnswers(batch, answers.data());
+	}
+};
+
+#endif // LEARNLIB_LIBALF_NATIVE_MEMBERSHIPORACLE_HPP
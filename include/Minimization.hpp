@@ -0,0 +1,85 @@
+/* Copyright (C) 2015 TU Dortmund
+ * This file is part of LearnLib, http://www.learnlib.de/.
+ * 
+ * LearnLib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 3.0 as published by the Free Software Foundation.
+ * 
+ * LearnLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with LearnLib; if not, see
+ * <http://www.gnu.de/documents/lgpl.en.html>.
+ */
+
+// Minimization.hpp
+// Post-processing of conjectures: Hopcroft minimization of DFAs and Mealy
+// machines, bounded determinization of NFAs, and checking conjectures
+// against the answers in the knowledgebase.
+
+#ifndef LEARNLIB_LIBALF_NATIVE_MINIMIZATION_HPP
+#define LEARNLIB_LIBALF_NATIVE_MINIMIZATION_HPP
+
+#include <cstddef>
+
+#include <jni.h>
+
+#include <libalf/knowledgebase.h>
+
+#include "FlatAutomaton.hpp"
+#include "Budget.hpp"
+
+namespace Minimization {
+
+struct Stats {
+	Stats(void) : conjectures(0), minimized(0), statesIn(0), statesOut(0), minimizeNanos(0),
+		checkedAnswers(0), inconsistencies(0), checkNanos(0) {}
+
+	jlong conjectures; // number of conjectures post-processed
+	jlong minimized; // number of conjectures replaced by a smaller automaton
+	jlong statesIn; // total number of states before minimization
+	jlong statesOut; // total number of states after minimization
+	jlong minimizeNanos;
+	jlong checkedAnswers; // answers from the knowledgebase checked
+	jlong inconsistencies; // answers contradicted by a conjecture
+	jlong checkNanos;
+};
+
+/*
+ * Computes the minimal DFA of the given deterministic automaton, restricted
+ * to the states reachable from its initial state. Undefined transitions are
+ * treated as leading to a rejecting sink, which is not part of the result.
+ * If the automaton is complete, the result is complete as well, unless
+ * partial is set, in which case transitions into dead states are always
+ * left undefined. Returns NULL if the budget expired.
+ */
+FlatAutomaton *minimizeDFA(const FlatAutomaton &dfa, bool partial = false, const Budget *budget = NULL);
+
+/*
+ * Computes the minimal Mealy machine equivalent to the given one, restricted
+ * to the states reachable from its initial state. Undefined transitions stay
+ * undefined; a defined transition into a state without defined transitions
+ * keeps its output and leads to a single such state. Returns NULL if the
+ * budget expired.
+ */
+FlatMealyMachine *minimizeMealy(const FlatMealyMachine &mm, const Budget *budget = NULL);
+
+/*
+ * Determinizes a nondeterministic automaton via the subset construction.
+ * Returns NULL if the result would have more than maxStates states, or if
+ * the budget expired.
+ */
+FlatAutomaton *determinize(const FlatAutomaton &nfa, size_t maxStates, const Budget *budget = NULL);
+
+/*
+ * Checks the automaton against all answers in the knowledgebase, returning
+ * the number of contradicted answers.
+ */
+size_t checkConsistency(const FlatAutomaton &fa, libalf::knowledgebase<bool> &kb, size_t &checkedAnswers);
+
+};
+
+#endif // LEARNLIB_LIBALF_NATIVE_MINIMIZATION_HPP
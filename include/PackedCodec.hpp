@@ -0,0 +1,195 @@
+/* Copyright (C) 2015 TU Dortmund
+ * This file is part of LearnLib, http://www.learnlib.de/.
+ * 
+ * LearnLib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 3.0 as published by the Free Software Foundation.
+ * 
+ * LearnLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with LearnLib; if not, see
+ * <http://www.gnu.de/documents/lgpl.en.html>.
+ */
+
+// PackedCodec.hpp
+// Compact byte-array encoding of words, word batches and boolean answers
+// exchanged with the Java side, as an alternative to WordCodec.
+//
+// Symbols are stored in lanes of 1, 2 or 4 bytes (little endian), chosen by
+// the Java side from the alphabet size (see laneBytes). A word is encoded as
+// its length as a varint, followed by its symbols; a batch is encoded as the
+// number of words as a varint, followed by the encoded words. Boolean
+// answers are packed into bitmaps, with answer i stored in bit i%8 of byte
+// i/8.
+
+#ifndef LEARNLIB_LIBALF_NATIVE_PACKEDCODEC_HPP
+#define LEARNLIB_LIBALF_NATIVE_PACKEDCODEC_HPP
+
+#include <jni.h>
+
+#include "QueryCursor.hpp"
+#include "ScratchWord.hpp"
+#include "Varint.hpp"
+
+namespace PackedCodec {
+
+// Returns the smallest lane width for the given alphabet size
+inline int laneBytes(jint alphabetSize)
+{
+	if (alphabetSize <= 0x100) {
+		return 1;
+	}
+	if (alphabetSize <= 0x10000) {
+		return 2;
+	}
+	return 4;
+}
+
+inline bool validLaneBytes(jint laneBytes)
+{
+	return laneBytes == 1 || laneBytes == 2 || laneBytes == 4;
+}
+
+/*
+ * Computes the size of the encoding of the batch in bytes. Returns false if
+ * a symbol of the batch does not fit into a lane.
+ */
+inline bool encodedBatchSize(const QueryBatch &batch, int laneBytes, size_t &size)
+{
+	uint32_t maxSym = (laneBytes == 4) ? 0xffffffffu : ((1u << (8 * laneBytes)) - 1);
+	size = Varint::size(batch.size());
+	for (QueryBatch::const_iterator it = batch.begin(); it != batch.end(); ++it) {
+		for (Word::const_iterator sit = it->begin(); sit != it->end(); ++sit) {
+			if (static_cast<uint32_t>(*sit) > maxSym) {
+				return false;
+			}
+		}
+		size += Varint::size(it->size()) + it->size() * laneBytes;
+	}
+	return true;
+}
+
+template<int LANE_BYTES>
+inline unsigned char *encodeSymbols(unsigned char *p, const Word &word)
+{
+	for (Word::const_iterator it = word.begin(); it != word.end(); ++it) {
+		uint32_t sym = static_cast<uint32_t>(*it);
+		for (int b = 0; b < LANE_BYTES; b++) {
+			p[b] = static_cast<unsigned char>(sym >> (8 * b));
+		}
+		p += LANE_BYTES;
+	}
+	return p;
+}
+
+/*
+ * Encodes the batch at the given position, returning the position after
+ * the encoded batch. The symbols must fit into the lanes.
+ */
+inline unsigned char *encodeBatch(unsigned char *p, const QueryBatch &batch, int laneBytes)
+{
+	p = Varint::write(p, batch.size());
+	for (QueryBatch::const_iterator it = batch.begin(); it != batch.end(); ++it) {
+		const Word &word = *it;
+		p = Varint::write(p, word.size());
+		switch (laneBytes) {
+		case 1:
+			p = encodeSymbols<1>(p, word);
+			break;
+		case 2:
+			p = encodeSymbols<2>(p, word);
+			break;
+		default:
+			p = encodeSymbols<4>(p, word);
+			break;
+		}
+	}
+	return p;
+}
+
+/*
+ * Decodes a word from the given position, which must not exceed end.
+ * Returns the position after the encoded word, or NULL if the encoding is
+ * truncated.
+ */
+inline const unsigned char *decodeWord(const unsigned char *p, const unsigned char *end, int laneBytes, Word &w)
+{
+	uint64_t wordLen;
+	p = Varint::get(p, end, wordLen);
+	if (!p || static_cast<uint64_t>(end - p) / laneBytes < wordLen) {
+		return NULL;
+	}
+	for (uint64_t i = 0; i < wordLen; i++) {
+		uint32_t sym = 0;
+		for (int b = 0; b < laneBytes; b++) {
+			sym |= static_cast<uint32_t>(*p++) << (8 * b);
+		}
+		w.push_back(static_cast<int>(sym));
+	}
+	return p;
+}
+
+// Like decodeWord, replacing the contents of a scratch word
+inline const unsigned char *decodeWord(const unsigned char *p, const unsigned char *end, int laneBytes, ScratchWord &w)
+{
+	uint64_t wordLen;
+	p = Varint::get(p, end, wordLen);
+	if (!p || static_cast<uint64_t>(end - p) / laneBytes < wordLen) {
+		return NULL;
+	}
+	w.resize(static_cast<size_t>(wordLen));
+	for (Word::iterator it = w.word().begin(); it != w.word().end(); ++it) {
+		uint32_t sym = 0;
+		for (int b = 0; b < laneBytes; b++) {
+			sym |= static_cast<uint32_t>(*p++) << (8 * b);
+		}
+		*it = static_cast<int>(sym);
+	}
+	return p;
+}
+
+// Decodes the number of words of a batch
+inline const unsigned char *decodeBatchSize(const unsigned char *p, const unsigned char *end, size_t &numWords)
+{
+	uint64_t n;
+	p = Varint::get(p, end, n);
+	numWords = static_cast<size_t>(n);
+	return p;
+}
+
+inline size_t bitmapSize(size_t numAnswers)
+{
+	return (numAnswers + 7) / 8;
+}
+
+inline bool answerBit(const unsigned char *bitmap, size_t i)
+{
+	return (bitmap[i / 8] >> (i % 8)) & 1;
+}
+
+/*
+ * Expands the first numAnswers answers of the bitmap into encoded answers
+ * (0 or 1), eight at a time.
+ */
+inline void unpackAnswers(const unsigned char *bitmap, size_t numAnswers, jint *answers)
+{
+	size_t fullBytes = numAnswers / 8;
+	for (size_t i = 0; i < fullBytes; i++) {
+		unsigned bits = bitmap[i];
+		jint *out = answers + 8 * i;
+		for (int b = 0; b < 8; b++) {
+			out[b] = static_cast<jint>((bits >> b) & 1);
+		}
+	}
+	for (size_t i = 8 * fullBytes; i < numAnswers; i++) {
+		answers[i] = answerBit(bitmap, i);
+	}
+}
+
+};
+
+#endif // LEARNLIB_LIBALF_NATIVE_PACKEDCODEC_HPP
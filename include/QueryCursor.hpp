@@ -0,0 +1,139 @@
+/* Copyright (C) 2015 TU Dortmund
+ * This file is part of LearnLib, http://www.learnlib.de/.
+ * 
+ * LearnLib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 3.0 as published by the Free Software Foundation.
+ * 
+ * LearnLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with LearnLib; if not, see
+ * <http://www.gnu.de/documents/lgpl.en.html>.
+ */
+
+// QueryCursor.hpp
+// Cursors for fetching the pending queries of a learner in pages of bounded
+// size, instead of materializing the whole batch at once.
+
+#ifndef LEARNLIB_LIBALF_NATIVE_QUERYCURSOR_HPP
+#define LEARNLIB_LIBALF_NATIVE_QUERYCURSOR_HPP
+
+#include <list>
+#include <vector>
+#include <cstddef>
+
+#include <libalf/knowledgebase.h>
+
+typedef std::list<int> Word;
+typedef std::list<Word> QueryBatch;
+
+class QueryCursor {
+public:
+	virtual ~QueryCursor(void) {}
+
+	/*
+	 * Moves the next page of queries into the given (empty) batch. A page
+	 * holds at most maxQueries words, and its encoding (see WordCodec)
+	 * takes at most maxInts ints, except that a page always holds at least
+	 * one word. A limit of 0 means no limit. Returns false once the cursor
+	 * is exhausted.
+	 */
+	virtual bool nextPage(QueryBatch &page, size_t maxQueries, size_t maxInts) = 0;
+
+protected:
+	static bool pageFull(size_t pageSize, size_t pageInts, size_t wordLen, size_t maxQueries, size_t maxInts)
+	{
+		if (!pageSize) {
+			return false;
+		}
+		if (maxQueries && pageSize >= maxQueries) {
+			return true;
+		}
+		// page header, plus length and symbols of the next word
+		return maxInts && 1 + pageInts + 1 + wordLen > maxInts;
+	}
+};
+
+/*
+ * Cursor over a fully materialized batch, for learners which cannot provide
+ * their pending queries incrementally. Pages are spliced out of the batch,
+ * so the words are not copied again.
+ */
+class BatchQueryCursor : public QueryCursor {
+public:
+	BatchQueryCursor(QueryBatch *batch) : m_batch(batch) {}
+	virtual ~BatchQueryCursor(void)
+	{
+		delete m_batch;
+	}
+
+	virtual bool nextPage(QueryBatch &page, size_t maxQueries, size_t maxInts)
+	{
+		QueryBatch::iterator end = m_batch->begin();
+		size_t pageInts = 0;
+		size_t pageSize = 0;
+		while (end != m_batch->end() && !pageFull(pageSize, pageInts, end->size(), maxQueries, maxInts)) {
+			pageInts += end->size() + 1;
+			pageSize++;
+			++end;
+		}
+		page.splice(page.end(), *m_batch, m_batch->begin(), end);
+		return !page.empty();
+	}
+
+private:
+	QueryBatch *m_batch;
+};
+
+/*
+ * Cursor over the pending queries of a knowledgebase. Only the query nodes
+ * are recorded when the cursor is opened; their words are materialized page
+ * by page. Queries which have been answered in the meantime are skipped.
+ * The cursor must not be used after the learner has advanced, or after a
+ * counterexample has been added.
+ */
+template<class A>
+class KnowledgebaseQueryCursor : public QueryCursor {
+public:
+	typedef typename libalf::knowledgebase<A>::node Node;
+
+public:
+	KnowledgebaseQueryCursor(libalf::knowledgebase<A> &kb) : m_pos(0)
+	{
+		m_nodes.reserve(kb.count_queries());
+		for (typename libalf::knowledgebase<A>::iterator it = kb.qbegin(); it != kb.qend(); ++it) {
+			m_nodes.push_back(&*it);
+		}
+	}
+
+	virtual bool nextPage(QueryBatch &page, size_t maxQueries, size_t maxInts)
+	{
+		size_t pageInts = 0;
+		while (m_pos < m_nodes.size()) {
+			Node *node = m_nodes[m_pos];
+			if (node->is_answered()) {
+				m_pos++;
+				continue;
+			}
+			Word w = node->get_word();
+			if (pageFull(page.size(), pageInts, w.size(), maxQueries, maxInts)) {
+				break;
+			}
+			pageInts += w.size() + 1;
+			page.push_back(Word());
+			page.back().swap(w);
+			m_pos++;
+		}
+		return !page.empty();
+	}
+
+private:
+	std::vector<Node *> m_nodes;
+	size_t m_pos;
+};
+
+#endif // LEARNLIB_LIBALF_NATIVE_QUERYCURSOR_HPP
@@ -0,0 +1,146 @@
+/* Copyright (C) 2015 TU Dortmund
+ * This file is part of LearnLib, http://www.learnlib.de/.
+ * 
+ * LearnLib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 3.0 as published by the Free Software Foundation.
+ * 
+ * LearnLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with LearnLib; if not, see
+ * <http://www.gnu.de/documents/lgpl.en.html>.
+ */
+
+// RemoteLearner.hpp
+// Thin client mode: a connection to the learner daemon, and a learner
+// proxy forwarding all operations to a learner hosted by the daemon.
+
+#ifndef LEARNLIB_LIBALF_NATIVE_REMOTELEARNER_HPP
+#define LEARNLIB_LIBALF_NATIVE_REMOTELEARNER_HPP
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <stdint.h>
+
+#include "LibalfLearner.hpp"
+#include "RemoteProtocol.hpp"
+
+class RemoteConnection {
+public:
+	/*
+	 * Connects to the daemon listening on the given socket. Returns an
+	 * empty pointer if the connection cannot be established (always on
+	 * platforms without daemon support).
+	 */
+	static std::shared_ptr<RemoteConnection> connect(const char *socketPath);
+	~RemoteConnection(void);
+
+	// Returns the ID of the new session, or 0 on failure
+	uint64_t createSession(const std::vector<std::string> &algNames);
+	void disposeSession(uint64_t sessionId);
+
+	LibalfLearner *createLearner(const std::shared_ptr<RemoteConnection> &self, uint64_t sessionId,
+			jint algorithmId, jint alphabetSize, size_t otherOptsLen, const jint *otherOpts);
+
+	/*
+	 * Performs a request, and waits for the response. The response payload
+	 * is stored in respPayload, or discarded if it is NULL. Requests from
+	 * several threads are serialized. If a budget is given, the request can
+	 * be cancelled via cancel, and is cancelled right away if the budget is.
+	 */
+	bool call(int32_t op, uint64_t id, int64_t arg, const void *payload, size_t payloadLen,
+			RemoteProtocol::MessageHeader &resp, std::vector<char> *respPayload, const Budget *budget = NULL);
+
+	// Cancels the request in progress if it was made with the given budget
+	void cancel(const Budget *budget);
+
+private:
+	RemoteConnection(int fd, void *segment);
+
+private:
+	std::mutex m_mutex;
+	int m_fd;
+	void *m_segment;
+	RemoteProtocol::Channel *m_channel;
+	RemoteProtocol::CancelControl *m_cancel;
+	bool m_broken;
+	uint32_t m_lastSeq;
+	// Sequence number and budget of the cancellable request in progress
+	std::atomic<uint32_t> m_activeSeq;
+	std::atomic<const Budget *> m_activeBudget;
+};
+
+class RemoteLearner : public LibalfLearner {
+public:
+	RemoteLearner(const std::shared_ptr<RemoteConnection> &conn, uint64_t id, bool booleanAnswers);
+	virtual ~RemoteLearner(void);
+
+	// Cancellation is forwarded to the daemon while a request is in progress
+	virtual void cancel(void);
+	virtual bool advance(void);
+	virtual QueryBatch *getQueries(void);
+	// Pages are fetched from a cursor in the daemon, so large query sets fit into messages
+	virtual QueryCursor *openQueryCursor(void);
+	virtual void addCounterExample(Word &ce);
+	/*
+	 * Single answers are buffered, and sent to the daemon along with the
+	 * next request. Hence, conflicting single answers are not reported.
+	 * Batches of answers and samples are sent right away, together with the
+	 * buffered answers, and the result of the daemon is returned.
+	 */
+	virtual bool addEncodedAnswer(Word &w, jint answer);
+	virtual bool addEncodedAnswers(QueryBatch &batch, const jint *answers);
+	virtual size_t addEncodedSamples(size_t numSamples, const jint *samplesEnc, const jint *samplesEnd, const jint *outputs);
+	virtual bool booleanAnswers(void) const;
+	virtual bool hasConjecture(void) const;
+	/*
+	 * If the encoding of the current conjecture was interrupted in the
+	 * daemon, it is requested again here, unless the budget has expired.
+	 */
+	virtual size_t computeConjectureSize(void) const;
+	virtual bool encodeConjecture(jbyte *buf, size_t size) const;
+
+	virtual bool setCounterExampleShortening(bool enable);
+	virtual const CEShortening::Stats *getCounterExampleStats(void) const;
+
+private:
+	// Returns false if the request failed, or an answer was conflicting
+	bool flushAnswers(void);
+	// Stores the conjecture contained in the response, returns false if there is none
+	bool receiveConjecture(const RemoteProtocol::MessageHeader &resp) const;
+
+private:
+	std::shared_ptr<RemoteConnection> m_conn;
+	uint64_t m_id;
+	bool m_booleanAnswers;
+	std::vector<int32_t> m_pendingWords;
+	std::vector<int32_t> m_pendingAnswers;
+	mutable std::vector<char> m_conjecture;
+	mutable bool m_timedOut;
+	// Set if the daemon derived a conjecture, but could not encode it in time
+	mutable bool m_retained;
+	mutable bool m_hasConjecture;
+	mutable CEShortening::Stats m_ceStats;
+};
+
+// Cursor over the pending queries of a remote learner, held by the daemon
+class RemoteQueryCursor : public QueryCursor {
+public:
+	RemoteQueryCursor(const std::shared_ptr<RemoteConnection> &conn, uint64_t id) : m_conn(conn), m_id(id) {}
+	virtual ~RemoteQueryCursor(void);
+
+	virtual bool nextPage(QueryBatch &page, size_t maxQueries, size_t maxInts);
+
+private:
+	std::shared_ptr<RemoteConnection> m_conn;
+	uint64_t m_id;
+};
+
+#endif // LEARNLIB_LIBALF_NATIVE_REMOTELEARNER_HPP
@@ -0,0 +1,173 @@
+/* Copyright (C) 2015 TU Dortmund
+ * This file is part of LearnLib, http://www.learnlib.de/.
+ * 
+ * LearnLib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 3.0 as published by the Free Software Foundation.
+ * 
+ * LearnLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with LearnLib; if not, see
+ * <http://www.gnu.de/documents/lgpl.en.html>.
+ */
+
+// RemoteProtocol.hpp
+// Protocol between the JNI library in thin client mode and the learner
+// daemon. Message headers are exchanged over a Unix domain socket, while
+// message payloads (queries, answers, conjectures) are streamed through a
+// pair of single-producer/single-consumer ring buffers in POSIX shared
+// memory, which is created by the client.
+
+#ifndef LEARNLIB_LIBALF_NATIVE_REMOTEPROTOCOL_HPP
+#define LEARNLIB_LIBALF_NATIVE_REMOTEPROTOCOL_HPP
+
+#include <atomic>
+#include <string>
+#include <stdint.h>
+
+namespace RemoteProtocol {
+
+enum Opcode {
+	HELLO = 1, // payload (over the socket): name of the shared memory segment
+	CREATE_SESSION = 2, // payload: NUL-terminated algorithm names
+	DISPOSE_SESSION = 3,
+	CREATE_LEARNER = 4, // arg: session ID; payload: int32 algorithm ID, alphabet size, options;
+		// response payload: int32 1 if the answers of the learner are boolean
+	DISPOSE_LEARNER = 5,
+	ADVANCE = 6, // arg: milliseconds until the deadline, or 0; see GET_CONJECTURE for timeouts
+	GET_QUERIES = 7,
+	ADD_ANSWERS = 8, // payload: int32 number of words, encoded words, answers; response arg: 0 on conflict
+	ADD_COUNTEREXAMPLE = 9, // payload: int32 symbols
+	SET_CE_SHORTENING = 10, // arg: 0 or 1
+	GET_CE_STATS = 11,
+	// arg: milliseconds until the deadline, or 0. Encodes the current
+	// conjecture again. For this and ADVANCE, the response arg of
+	// STATUS_TIMED_OUT is 1 if a conjecture was derived but its encoding
+	// was interrupted, so it can be fetched later.
+	GET_CONJECTURE = 12,
+	ADD_SAMPLES = 13, // payload as for ADD_ANSWERS; response arg: number of samples added
+	// Cursors over the pending queries of a learner (see QueryCursor). The
+	// response arg of OPEN_QUERY_CURSOR is the ID of the cursor, which the
+	// other two requests refer to. FETCH_QUERY_PAGE takes the int32 maximum
+	// number of queries and ints of the page as payload, and responds with
+	// the encoded page, with arg 1, or with arg 0 once the cursor is
+	// exhausted.
+	OPEN_QUERY_CURSOR = 14,
+	FETCH_QUERY_PAGE = 15,
+	CLOSE_QUERY_CURSOR = 16
+};
+
+enum Status {
+	STATUS_ERROR = -1,
+	STATUS_OK = 0,
+	STATUS_CONJECTURE = 1,
+	STATUS_TIMED_OUT = 2
+};
+
+struct MessageHeader {
+	int32_t code; // opcode for requests, status for responses
+	uint32_t seq; // nonzero sequence number of a request, see CancelControl
+	uint64_t id; // ID of the session or learner the request refers to
+	int64_t arg;
+	uint64_t payloadLen;
+};
+
+// Capacity of each of the two ring buffers
+static const size_t RING_CAPACITY = 4 << 20;
+// Bound on the payload of a single message; peers sending more are
+// disconnected. The daemon reports larger responses as STATUS_ERROR.
+static const uint64_t MAX_PAYLOAD_LEN = 64 * static_cast<uint64_t>(RING_CAPACITY);
+
+struct RingControl {
+	std::atomic<uint64_t> head; // total number of bytes written
+	char pad1[64 - sizeof(std::atomic<uint64_t>)];
+	std::atomic<uint64_t> tail; // total number of bytes read
+	char pad2[64 - sizeof(std::atomic<uint64_t>)];
+};
+
+/*
+ * Cancellation requests bypass the rings, as the client waits for the
+ * response to the request it cancels: the client stores the sequence number
+ * of that request, and the daemon treats the budget of the learner as
+ * expired while it processes a request with this number.
+ */
+struct CancelControl {
+	std::atomic<uint32_t> cancelSeq;
+	char pad[64 - sizeof(std::atomic<uint32_t>)];
+};
+
+/*
+ * Size of the shared memory segment: control block and data area of the
+ * request ring, followed by those of the response ring, and the
+ * cancellation control block.
+ */
+static const size_t SEGMENT_SIZE = 2 * (sizeof(RingControl) + RING_CAPACITY) + sizeof(CancelControl);
+
+class Ring {
+public:
+	Ring(void *mem) :
+		m_ctrl(static_cast<RingControl *>(mem)),
+		m_data(static_cast<char *>(mem) + sizeof(RingControl))
+	{}
+
+	/*
+	 * Writes/reads len bytes, blocking while the ring is full/empty. While
+	 * blocking, peerFd is polled, and false is returned once the peer has
+	 * closed the connection.
+	 */
+	bool write(const void *data, size_t len, int peerFd);
+	bool read(void *data, size_t len, int peerFd);
+
+private:
+	RingControl *m_ctrl;
+	char *m_data;
+};
+
+/*
+ * One end of a connection: the socket, plus the ring used for outgoing and
+ * the one used for incoming payloads.
+ */
+class Channel {
+public:
+	Channel(int fd, void *segment, bool client);
+
+	int fd(void) const { return m_fd; }
+
+	bool send(const MessageHeader &hdr, const void *payload);
+	bool receiveHeader(MessageHeader &hdr);
+	bool receivePayload(void *buf, size_t len);
+	// Discards a payload that cannot be processed
+	bool skipPayload(size_t len);
+
+private:
+	int m_fd;
+	Ring m_out;
+	Ring m_in;
+};
+
+// Prevents SIGPIPE on sockets where MSG_NOSIGNAL is not available
+void configureSocket(int fd);
+
+/*
+ * Creates and maps a new shared memory segment of SEGMENT_SIZE bytes,
+ * storing its name in the given string. The creator unlinks the segment
+ * once the peer has mapped it, so it does not outlive a crashed process.
+ */
+void *createSegment(std::string &name);
+// Maps the named segment, returns NULL if it is smaller than SEGMENT_SIZE
+void *openSegment(const char *name);
+void unlinkSegment(const std::string &name);
+void releaseSegment(void *segment);
+CancelControl *cancelControl(void *segment);
+
+// Reliable transfer over the socket, handling partial reads and writes
+bool sendAll(int fd, const void *data, size_t len);
+bool receiveAll(int fd, void *data, size_t len);
+
+};
+
+#endif // LEARNLIB_LIBALF_NATIVE_REMOTEPROTOCOL_HPP
@@ -16,24 +16,38 @@
  */
 
 // SAF.hpp
-// Utilities for encoding libalf conjectures into the Simple Automaton
-// Format.
+// Utilities for encoding conjectures, in their flat representation, into
+// the Simple Automaton Format.
 // Author: Malte Isberner
 
 #ifndef SAF_HPP
 #define SAF_HPP
 
-#include <libalf/conjecture.h>
+#include <jni.h>
+
+#include "FlatAutomaton.hpp"
+#include "Budget.hpp"
 
 namespace SAF {
 
-size_t computeDFASize(const libalf::finite_automaton &fa);
-void encodeDFA(jbyte *buf, size_t len, const libalf::finite_automaton &fa);
+/*
+ * Sets the minimum size (in bytes) of an encoding for which the transitions
+ * are written in parallel, using the shared thread pool.
+ */
+void setParallelThreshold(size_t minBytes);
+
+
+size_t computeDFASize(const FlatAutomaton &fa);
+/*
+ * Encodes a DFA into SAF, stored in the given buffer. If a budget is
+ * specified, encoding stops and false is returned once it has expired.
+ */
+bool encodeDFA(jbyte *buf, size_t len, const FlatAutomaton &fa, const Budget *budget = NULL);
 /*
  * Encodes a DFA into SAF, stored in a byte array. The size of the allocated
  * array is returned via the second parameter.
  */
-inline jbyte *encodeDFA(const libalf::finite_automaton &fa, size_t &sizeOut)
+inline jbyte *encodeDFA(const FlatAutomaton &fa, size_t &sizeOut)
 {
 	size_t size = computeDFASize(fa);
 	sizeOut = size;
@@ -43,13 +57,17 @@ inline jbyte *encodeDFA(const libalf::finite_automaton &fa, size_t &sizeOut)
 }
 
 
-size_t computeNFASize(const libalf::finite_automaton &fa);
-void encodeNFA(jbyte *buf, size_t len, const libalf::finite_automaton &fa);
+size_t computeNFASize(const FlatAutomaton &fa);
+/*
+ * Encodes an NFA into SAF, stored in the given buffer. If a budget is
+ * specified, encoding stops and false is returned once it has expired.
+ */
+bool encodeNFA(jbyte *buf, size_t len, const FlatAutomaton &fa, const Budget *budget = NULL);
 /*
  * Encodes an NFA into SAF, stored in a byte array. The size of the allocated
  * array is returned via the second parameter.
  */
-inline jbyte *encodeNFA(const libalf::finite_automaton &fa, size_t &sizeOut)
+inline jbyte *encodeNFA(const FlatAutomaton &fa, size_t &sizeOut)
 {
 	size_t size = computeNFASize(fa);
 	sizeOut = size;
@@ -58,6 +76,32 @@ inline jbyte *encodeNFA(const libalf::finite_automaton &fa, size_t &sizeOut)
 	return buf;
 }
 
+
+/*
+ * Mealy machines are encoded with their initial state, followed by the
+ * successor and output of every transition. An undefined transition has
+ * successor -1 and output 0, which is to be ignored.
+ */
+size_t computeMealySize(const FlatMealyMachine &mm);
+bool encodeMealy(jbyte *buf, size_t len, const FlatMealyMachine &mm, const Budget *budget = NULL);
+
+
+/*
+ * Encodings in parts: the part for the states [begin, end) holds their
+ * transitions, preceded by everything before the transitions if begin is 0.
+ * Hence the parts for consecutive nonempty ranges covering all states
+ * concatenate to the full encoding. The range must satisfy
+ * 0 <= begin <= end <= numStates.
+ */
+size_t computeDFAPartSize(const FlatAutomaton &fa, int begin, int end);
+bool encodeDFAPart(jbyte *buf, size_t len, const FlatAutomaton &fa, int begin, int end, const Budget *budget = NULL);
+
+size_t computeNFAPartSize(const FlatAutomaton &fa, int begin, int end);
+bool encodeNFAPart(jbyte *buf, size_t len, const FlatAutomaton &fa, int begin, int end, const Budget *budget = NULL);
+
+size_t computeMealyPartSize(const FlatMealyMachine &mm, int begin, int end);
+bool encodeMealyPart(jbyte *buf, size_t len, const FlatMealyMachine &mm, int begin, int end, const Budget *budget = NULL);
+
 };
 
 #endif
\ No newline at end of file
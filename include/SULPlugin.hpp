@@ -0,0 +1,61 @@
+/* Copyright (C) 2015 TU Dortmund
+ * This file is part of LearnLib, http://www.learnlib.de/.
+ * 
+ * LearnLib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 3.0 as published by the Free Software Foundation.
+ * 
+ * LearnLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with LearnLib; if not, see
+ * <http://www.gnu.de/documents/lgpl.en.html>.
+ */
+
+// SULPlugin.hpp
+// Membership oracle backed by a native SUL plugin, loaded from a shared
+// library at runtime. Queries may be distributed over several independent
+// SUL instances.
+
+#ifndef LEARNLIB_LIBALF_NATIVE_SULPLUGIN_HPP
+#define LEARNLIB_LIBALF_NATIVE_SULPLUGIN_HPP
+
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+
+#include "MembershipOracle.hpp"
+#include "learnlib_sul.h"
+
+class SULPlugin : public MembershipOracle {
+public:
+	/*
+	 * Loads the plugin from the given path, and creates the given number of
+	 * SUL instances. Returns NULL if the plugin cannot be loaded, or not all
+	 * instances can be created.
+	 */
+	static SULPlugin *load(const char *path, const char *config, unsigned numInstances);
+	virtual ~SULPlugin(void);
+
+	virtual void answerQueries(const QueryBatch &batch, jint *answers);
+
+private:
+	SULPlugin(void *handle, const learnlib_sul_plugin *plugin);
+
+	void *acquire(void);
+	void release(void *sul);
+	void answerRange(void *sul, const Word *const *words, size_t numWords, jint *answers) const;
+
+private:
+	void *m_handle;
+	const learnlib_sul_plugin *m_plugin;
+	std::vector<void *> m_instances;
+	std::vector<void *> m_idle;
+	std::mutex m_mutex;
+	std::condition_variable m_available;
+};
+
+#endif // LEARNLIB_LIBALF_NATIVE_SULPLUGIN_HPP
@@ -0,0 +1,57 @@
+/* Copyright (C) 2015 TU Dortmund
+ * This file is part of LearnLib, http://www.learnlib.de/.
+ * 
+ * LearnLib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 3.0 as published by the Free Software Foundation.
+ * 
+ * LearnLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with LearnLib; if not, see
+ * <http://www.gnu.de/documents/lgpl.en.html>.
+ */
+
+// ScratchWord.hpp
+// Decoding of words from JNI buffers without per-symbol allocations, into
+// a scratch word in the list form required by libalf, whose list nodes are
+// recycled.
+
+#ifndef LEARNLIB_LIBALF_NATIVE_SCRATCHWORD_HPP
+#define LEARNLIB_LIBALF_NATIVE_SCRATCHWORD_HPP
+
+#include <cstddef>
+
+#include <jni.h>
+
+#include "QueryCursor.hpp"
+
+/*
+ * A word whose list nodes are kept on a spare list when it shrinks, and
+ * taken from there when it grows, so that no allocations happen once the
+ * longest word seen so far has been built.
+ */
+class ScratchWord {
+public:
+	Word &word(void) { return m_word; }
+
+	void resize(size_t len);
+
+	void assign(const jint *begin, const jint *end)
+	{
+		resize(static_cast<size_t>(end - begin));
+		Word::iterator it = m_word.begin();
+		for (const jint *p = begin; p != end; ++p) {
+			*it++ = static_cast<int>(*p);
+		}
+	}
+
+private:
+	Word m_word;
+	Word m_spare;
+};
+
+#endif // LEARNLIB_LIBALF_NATIVE_SCRATCHWORD_HPP
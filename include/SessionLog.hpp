@@ -0,0 +1,144 @@
+/* Copyright (C) 2015 TU Dortmund
+ * This file is part of LearnLib, http://www.learnlib.de/.
+ * 
+ * LearnLib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 3.0 as published by the Free Software Foundation.
+ * 
+ * LearnLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with LearnLib; if not, see
+ * <http://www.gnu.de/documents/lgpl.en.html>.
+ */
+
+// SessionLog.hpp
+// Recording of the calls made to a learner across the JNI boundary, and
+// reading of recorded sessions for replay without a JVM or SUL.
+
+#ifndef LEARNLIB_LIBALF_NATIVE_SESSIONLOG_HPP
+#define LEARNLIB_LIBALF_NATIVE_SESSIONLOG_HPP
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include <jni.h>
+
+#include "QueryCursor.hpp"
+
+/*
+ * A session log starts with the magic "LLRS" and a version byte, followed
+ * by records. Each record starts with its type byte; all integers are
+ * varints, signed ones zig-zag encoded. Words are stored as their length
+ * followed by their symbols.
+ */
+namespace SessionLog {
+
+enum RecordType {
+	INIT = 1, // algorithm name (length, bytes), alphabet size, options (count, signed values)
+	ADVANCE = 2, // 1 if a conjecture was derived, size of its SAF encoding (0 otherwise)
+	QUERIES = 3, // number of queries, 64-bit hash of the batch
+	ANSWERS = 4, // number of answers, words, signed answers
+	COUNTEREXAMPLE = 5, // word
+	SAMPLES = 6, // like ANSWERS, for samples of passive learners
+	CE_SHORTENING = 7, // 1 if enabled
+	POST_PROCESSING = 8, // 1 if minimization is enabled, 1 if verification is enabled
+	SPILL = 9, // maximum number of hot answers; only recorded if spilling was enabled
+	DEADLINE = 10, // milliseconds until the deadline, 0 if it was removed
+	CANCEL = 11,
+	FORK = 12 // answers given to the fork are not part of the log
+};
+
+uint64_t hashBatch(const QueryBatch &batch);
+
+/*
+ * Sets the directory in which sessions of newly created learners are
+ * recorded, or disables recording if dir is NULL. Initially, the directory
+ * is taken from the environment variable LEARNLIB_LIBALF_RECORD_DIR.
+ */
+void setRecordingDirectory(const char *dir);
+
+class Recorder {
+public:
+	/*
+	 * Creates a recorder for a new learner in the recording directory, or
+	 * returns NULL if recording is disabled or the file cannot be created.
+	 */
+	static Recorder *create(const std::string &algName, jint alphabetSize, size_t numOpts, const jint *opts);
+	~Recorder(void);
+
+	void recordAdvance(bool conjecture, size_t safSize);
+	void recordQueries(const QueryBatch &batch);
+	void recordAnswers(const QueryBatch &batch, const jint *answers);
+	void recordCounterExample(const Word &ce);
+	void recordSamples(const QueryBatch &samples, const jint *outputs);
+	void recordCEShortening(bool enable);
+	void recordPostProcessing(bool minimize, bool verify);
+	void recordSpill(jlong maxHotAnswers);
+	void recordDeadline(jlong millis);
+	void recordCancel(void);
+	void recordFork(void);
+
+	/*
+	 * Returns true if writing the log failed. A log with a gap cannot be
+	 * replayed, so nothing is written after a failure.
+	 */
+	bool failed(void) const { return m_failed; }
+
+private:
+	Recorder(std::FILE *file) : m_file(file), m_failed(false) {}
+
+	void putWord(const Word &w);
+	void putWordsWithAnswers(const QueryBatch &words, const jint *answers);
+	void flush(void);
+
+private:
+	std::FILE *m_file;
+	std::vector<unsigned char> m_buf;
+	bool m_failed;
+};
+
+struct Record {
+	RecordType type;
+	std::string name;
+	std::vector<jint> ints;
+	QueryBatch words;
+	uint64_t hash;
+	jlong value; // for SPILL and DEADLINE
+};
+
+class Reader {
+public:
+	Reader(void) : m_pos(0), m_failed(false) {}
+
+	// Reads the whole log into memory
+	bool open(const char *path);
+	void rewind(void);
+
+	/*
+	 * Reads the next record. Returns false at the end of the log, with
+	 * error() indicating whether the log is corrupt.
+	 */
+	bool next(Record &rec);
+	bool error(void) const { return m_failed; }
+
+private:
+	bool getInt(jint &value, bool isSigned);
+	bool getLong(jlong &value);
+	bool getWord(Word &w);
+	bool getWordsWithAnswers(Record &rec);
+
+private:
+	std::vector<unsigned char> m_data;
+	size_t m_pos;
+	bool m_failed;
+};
+
+};
+
+#endif // LEARNLIB_LIBALF_NATIVE_SESSIONLOG_HPP
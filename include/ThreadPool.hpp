@@ -0,0 +1,86 @@
+/* Copyright (C) 2015 TU Dortmund
+ * This file is part of LearnLib, http://www.learnlib.de/.
+ * 
+ * LearnLib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 3.0 as published by the Free Software Foundation.
+ * 
+ * LearnLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with LearnLib; if not, see
+ * <http://www.gnu.de/documents/lgpl.en.html>.
+ */
+
+// ThreadPool.hpp
+// A fixed-size pool of native worker threads, executing index-parallel
+// jobs. Work items are claimed dynamically, so uneven items are balanced
+// across the workers.
+
+#ifndef LEARNLIB_LIBALF_NATIVE_THREADPOOL_HPP
+#define LEARNLIB_LIBALF_NATIVE_THREADPOOL_HPP
+
+#include <list>
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+class ThreadPool {
+public:
+	typedef std::function<void(size_t)> Task;
+
+public:
+	/*
+	 * Creates a pool with the given number of worker threads. If numThreads
+	 * is 0, one thread per hardware thread is used.
+	 */
+	explicit ThreadPool(unsigned numThreads);
+	~ThreadPool(void);
+
+	unsigned size(void) const { return static_cast<unsigned>(m_workers.size()); }
+
+	/*
+	 * Invokes task(i) for every i in [0, n), and blocks until all
+	 * invocations have completed. The calling thread takes part in the
+	 * execution. Several threads may submit jobs concurrently.
+	 */
+	void parallelFor(size_t n, const Task &task);
+
+	/*
+	 * The pool shared by all native components of this library.
+	 */
+	static std::shared_ptr<ThreadPool> shared(void);
+	static void configureShared(unsigned numThreads);
+
+private:
+	struct Job {
+		Job(size_t n, const Task &task) : task(task), numItems(n), next(0), finished(0), active(0) {}
+
+		const Task &task;
+		size_t numItems;
+		std::atomic<size_t> next;
+		size_t finished; // guarded by m_mutex
+		unsigned active; // guarded by m_mutex
+	};
+
+private:
+	static size_t runItems(Job &job);
+	void workerLoop(void);
+
+private:
+	std::vector<std::thread> m_workers;
+	std::list<Job *> m_jobs;
+	std::mutex m_mutex;
+	std::condition_variable m_wake;
+	std::condition_variable m_done;
+	bool m_shutdown;
+};
+
+#endif // LEARNLIB_LIBALF_NATIVE_THREADPOOL_HPP
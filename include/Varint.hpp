@@ -0,0 +1,93 @@
+/* Copyright (C) 2015 TU Dortmund
+ * This file is part of LearnLib, http://www.learnlib.de/.
+ * 
+ * LearnLib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 3.0 as published by the Free Software Foundation.
+ * 
+ * LearnLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with LearnLib; if not, see
+ * <http://www.gnu.de/documents/lgpl.en.html>.
+ */
+
+// Varint.hpp
+// Variable-length (LEB128) encoding of integers, as used by the binary file
+// formats. Signed values are zig-zag encoded first, so that small negative
+// values stay short.
+
+#ifndef LEARNLIB_LIBALF_NATIVE_VARINT_HPP
+#define LEARNLIB_LIBALF_NATIVE_VARINT_HPP
+
+#include <vector>
+#include <cstddef>
+#include <stdint.h>
+
+namespace Varint {
+
+inline void put(std::vector<unsigned char> &buf, uint64_t value)
+{
+	while (value >= 0x80) {
+		buf.push_back(static_cast<unsigned char>(value | 0x80));
+		value >>= 7;
+	}
+	buf.push_back(static_cast<unsigned char>(value));
+}
+
+// Returns the number of bytes of the encoding of value
+inline size_t size(uint64_t value)
+{
+	size_t n = 1;
+	while (value >= 0x80) {
+		value >>= 7;
+		n++;
+	}
+	return n;
+}
+
+// Writes the encoding of value at p, returning the position after it
+inline unsigned char *write(unsigned char *p, uint64_t value)
+{
+	while (value >= 0x80) {
+		*p++ = static_cast<unsigned char>(value | 0x80);
+		value >>= 7;
+	}
+	*p++ = static_cast<unsigned char>(value);
+	return p;
+}
+
+/*
+ * Decodes a value at the given position, which must not exceed end.
+ * Returns the position after the value, or NULL if it is truncated.
+ */
+inline const unsigned char *get(const unsigned char *p, const unsigned char *end, uint64_t &value)
+{
+	value = 0;
+	for (unsigned shift = 0; p != end && shift < 64; shift += 7) {
+		unsigned char byte = *p++;
+		value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+		if (!(byte & 0x80)) {
+			return p;
+		}
+	}
+	return NULL;
+}
+
+inline uint32_t zigZag(int32_t value)
+{
+	return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+}
+
+inline int32_t unZigZag(uint64_t value)
+{
+	uint32_t zz = static_cast<uint32_t>(value);
+	return static_cast<int32_t>((zz >> 1) ^ (0u - (zz & 1)));
+}
+
+};
+
+#endif // LEARNLIB_LIBALF_NATIVE_VARINT_HPP
@@ -0,0 +1,93 @@
+/* Copyright (C) 2015 TU Dortmund
+ * This file is part of LearnLib, http://www.learnlib.de/.
+ * 
+ * LearnLib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 3.0 as published by the Free Software Foundation.
+ * 
+ * LearnLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with LearnLib; if not, see
+ * <http://www.gnu.de/documents/lgpl.en.html>.
+ */
+
+// WordCodec.hpp
+// Utility functions for the int-array encoding of words and word batches
+// exchanged with the Java side. A word is encoded as its length followed by
+// its symbols; a batch is encoded as the number of words followed by the
+// encoded words.
+
+#ifndef LEARNLIB_LIBALF_NATIVE_WORDCODEC_HPP
+#define LEARNLIB_LIBALF_NATIVE_WORDCODEC_HPP
+
+#include <jni.h>
+
+#include "QueryCursor.hpp"
+
+namespace WordCodec {
+
+inline size_t encodedBatchSize(const QueryBatch &batch)
+{
+	size_t totalSpace = 1;
+	for (QueryBatch::const_iterator it = batch.begin(); it != batch.end(); ++it) {
+		totalSpace += it->size() + 1;
+	}
+	return totalSpace;
+}
+
+/*
+ * Encodes the batch at the given position, returning the position after
+ * the encoded batch.
+ */
+inline jint *encodeBatch(jint *p, const QueryBatch &batch)
+{
+	*p++ = static_cast<jint>(batch.size());
+	for (QueryBatch::const_iterator it = batch.begin(); it != batch.end(); ++it) {
+		const Word &word = *it;
+		*p++ = static_cast<jint>(word.size());
+		for (Word::const_iterator it2 = word.begin(); it2 != word.end(); ++it2) {
+			*p++ = static_cast<jint>(*it2);
+		}
+	}
+	return p;
+}
+
+/*
+ * Returns the position after the word encoded at the given position, which
+ * must not exceed end, or NULL if the encoding is truncated.
+ */
+inline const jint *skipWord(const jint *p, const jint *end)
+{
+	if (p == end || *p < 0 || end - (p + 1) < *p) {
+		return NULL;
+	}
+	return p + 1 + *p;
+}
+
+/*
+ * Decodes a word from the given position, which must not exceed end.
+ * Returns the position after the encoded word, or NULL if the encoding is
+ * truncated.
+ */
+inline const jint *decodeWord(const jint *p, const jint *end, Word &w)
+{
+	if (p == end) {
+		return NULL;
+	}
+	jint wordLen = *p++;
+	if (wordLen < 0 || end - p < wordLen) {
+		return NULL;
+	}
+	while (wordLen--) {
+		w.push_back(static_cast<int>(*p++));
+	}
+	return p;
+}
+
+};
+
+#endif // LEARNLIB_LIBALF_NATIVE_WORDCODEC_HPP
@@ -0,0 +1,75 @@
+/* Copyright (C) 2015 TU Dortmund
+ * This file is part of LearnLib, http://www.learnlib.de/.
+ * 
+ * LearnLib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 3.0 as published by the Free Software Foundation.
+ * 
+ * LearnLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with LearnLib; if not, see
+ * <http://www.gnu.de/documents/lgpl.en.html>.
+ */
+
+/* learnlib_sul.h
+ * C ABI for native system-under-learning (SUL) plugins. A plugin is a
+ * shared library exporting the function LEARNLIB_SUL_ENTRY_POINT, which
+ * returns a pointer to a statically allocated plugin descriptor.
+ */
+
+#ifndef LEARNLIB_SUL_H
+#define LEARNLIB_SUL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LEARNLIB_SUL_ABI_VERSION 1
+#define LEARNLIB_SUL_ENTRY_POINT "learnlib_sul_plugin_v1"
+
+typedef struct learnlib_sul_plugin {
+	/* Must be set to LEARNLIB_SUL_ABI_VERSION */
+	int32_t abi_version;
+
+	/*
+	 * Creates a new SUL instance, independent of all other instances.
+	 * The configuration string may be NULL. Returns NULL on failure.
+	 */
+	void *(*create)(const char *config);
+
+	/* Destroys a SUL instance */
+	void (*destroy)(void *sul);
+
+	/*
+	 * Resets the SUL to its initial state, and returns the output for the
+	 * empty word.
+	 */
+	int32_t (*reset)(void *sul);
+
+	/* Executes one input symbol, and returns the resulting output */
+	int32_t (*step)(void *sul, int32_t symbol);
+
+	/*
+	 * Optional (may be NULL): answers a batch of queries at once. The
+	 * queries are encoded as consecutive words, each consisting of its
+	 * length followed by its symbols. The output of each query, i.e., the
+	 * output after its last symbol, is stored in answers. Returns 0 on
+	 * success.
+	 */
+	int32_t (*query_batch)(void *sul, const int32_t *queries, size_t num_queries, int32_t *answers);
+} learnlib_sul_plugin;
+
+typedef const learnlib_sul_plugin *learnlib_sul_entry_point(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LEARNLIB_SUL_H */
@@ -0,0 +1,108 @@
+/* Copyright (C) 2015 TU Dortmund
+ * This file is part of LearnLib, http://www.learnlib.de/.
+ * 
+ * LearnLib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 3.0 as published by the Free Software Foundation.
+ * 
+ * LearnLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with LearnLib; if not, see
+ * <http://www.gnu.de/documents/lgpl.en.html>.
+ */
+
+// AnswerCache.cpp
+// Implementation of the answer cache shared by a fork family
+
+#include "AnswerCache.hpp"
+
+// Initial number of slots of the child table, a power of two
+static const size_t INITIAL_SLOTS = 1024;
+
+static size_t slotHash(uint64_t key)
+{
+	key ^= key >> 33;
+	key *= 0xff51afd7ed558ccdull;
+	key ^= key >> 33;
+	return static_cast<size_t>(key);
+}
+
+AnswerCache::AnswerCache(void)
+	: m_usedSlots(0), m_answers(1, 0), m_answered(1, false), m_size(0), m_hits(0)
+{
+	Slot empty = { 0, 0 };
+	m_slots.assign(INITIAL_SLOTS, empty);
+}
+
+size_t AnswerCache::findSlot(uint64_t key) const
+{
+	size_t mask = m_slots.size() - 1;
+	size_t i = slotHash(key) & mask;
+	while (m_slots[i].key != 0 && m_slots[i].key != key) {
+		i = (i + 1) & mask;
+	}
+	return i;
+}
+
+void AnswerCache::grow(void)
+{
+	std::vector<Slot> old;
+	old.swap(m_slots);
+	Slot empty = { 0, 0 };
+	m_slots.assign(old.size() * 2, empty);
+	for (std::vector<Slot>::const_iterator it = old.begin(); it != old.end(); ++it) {
+		if (it->key != 0) {
+			m_slots[findSlot(it->key)] = *it;
+		}
+	}
+}
+
+bool AnswerCache::lookup(const Word &w, jint &answer)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	Node node = 0;
+	for (Word::const_iterator it = w.begin(); it != w.end(); ++it) {
+		const Slot &slot = m_slots[findSlot(childKey(node, *it))];
+		if (slot.key == 0) {
+			return false;
+		}
+		node = slot.child;
+	}
+	if (!m_answered[node]) {
+		return false;
+	}
+	answer = m_answers[node];
+	m_hits++;
+	return true;
+}
+
+void AnswerCache::storeLocked(const Word &w, jint answer)
+{
+	Node node = 0;
+	for (Word::const_iterator it = w.begin(); it != w.end(); ++it) {
+		uint64_t key = childKey(node, *it);
+		size_t i = findSlot(key);
+		if (m_slots[i].key == 0) {
+			// keeps the load factor at most 1/2
+			if (2 * (m_usedSlots + 1) > m_slots.size()) {
+				grow();
+				i = findSlot(key);
+			}
+			m_slots[i].key = key;
+			m_slots[i].child = static_cast<Node>(m_answers.size());
+			m_usedSlots++;
+			m_answers.push_back(0);
+			m_answered.push_back(false);
+		}
+		node = m_slots[i].child;
+	}
+	if (!m_answered[node]) {
+		m_answered[node] = true;
+		m_size++;
+	}
+	m_answers[node] = answer;
+}
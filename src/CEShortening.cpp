@@ -0,0 +1,280 @@
+/* Copyright (C) 2015 TU Dortmund
+ * This file is part of LearnLib, http://www.learnlib.de/.
+ * 
+ * LearnLib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 3.0 as published by the Free Software Foundation.
+ * 
+ * LearnLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with LearnLib; if not, see
+ * <http://www.gnu.de/documents/lgpl.en.html>.
+ */
+
+// CEShortening.cpp
+// Implementation of the knowledgebase-driven counterexample shortening
+
+#include <map>
+#include <vector>
+#include <deque>
+#include <algorithm>
+
+#include "CEShortening.hpp"
+
+namespace CEShortening {
+
+typedef std::vector<int> Seq;
+
+namespace {
+
+class DFAView {
+public:
+	DFAView(const FlatAutomaton &fa)
+		: m_fa(fa), m_init(fa.initialStates().front())
+	{}
+
+	int successor(int state, int sym) const
+	{
+		if (state < 0 || sym < 0 || sym >= m_fa.alphabetSize()) {
+			return -1;
+		}
+		return m_fa.successor(state, sym);
+	}
+
+	bool accepting(int state) const
+	{
+		return (state >= 0 && m_fa.isAccepting(state));
+	}
+
+	// Computes the sequence of states q_0, ..., q_n visited on w
+	void run(const Seq &w, Seq &states) const
+	{
+		states.resize(w.size() + 1);
+		int q = m_init;
+		states[0] = q;
+		for (size_t i = 0; i < w.size(); i++) {
+			q = successor(q, w[i]);
+			states[i + 1] = q;
+		}
+	}
+
+	// Computes shortest access sequences via breadth-first search
+	void accessSequences(std::vector<Seq> &acc) const
+	{
+		int numStates = m_fa.numStates();
+		int alphabetSize = m_fa.alphabetSize();
+		std::vector<int> pred(numStates, -1);
+		std::vector<int> predSym(numStates, -1);
+		std::vector<bool> reached(numStates, false);
+
+		std::deque<int> queue;
+		reached[m_init] = true;
+		queue.push_back(m_init);
+		while (!queue.empty()) {
+			int q = queue.front();
+			queue.pop_front();
+			for (int a = 0; a < alphabetSize; a++) {
+				int succ = successor(q, a);
+				if (succ >= 0 && succ < numStates && !reached[succ]) {
+					reached[succ] = true;
+					pred[succ] = q;
+					predSym[succ] = a;
+					queue.push_back(succ);
+				}
+			}
+		}
+
+		acc.assign(numStates, Seq());
+		for (int q = 0; q < numStates; q++) {
+			if (!reached[q]) {
+				continue;
+			}
+			Seq &as = acc[q];
+			for (int p = q; p != m_init; p = pred[p]) {
+				as.push_back(predSym[p]);
+			}
+			std::reverse(as.begin(), as.end());
+		}
+	}
+
+	bool reachable(const std::vector<Seq> &acc, int state) const
+	{
+		if (state < 0 || static_cast<size_t>(state) >= acc.size()) {
+			return false;
+		}
+		return (state == m_init || !acc[state].empty());
+	}
+
+private:
+	const FlatAutomaton &m_fa;
+	int m_init;
+};
+
+class Oracle {
+public:
+	Oracle(const libalf::knowledgebase<bool> &kb, Stats &stats)
+		: m_kb(kb), m_stats(stats)
+	{}
+
+	bool lookup(const Seq &w, bool &answer)
+	{
+		std::list<int> word(w.begin(), w.end());
+		if (!m_kb.resolve_query(word, answer)) {
+			return false;
+		}
+		m_stats.knowledgeHits++;
+		return true;
+	}
+
+private:
+	const libalf::knowledgebase<bool> &m_kb;
+	Stats &m_stats;
+};
+
+}
+
+/*
+ * Performs a binary search for a breakpoint in the decomposition
+ * acc(q_i) w[i..n), where q_i is the state reached after reading the first
+ * i symbols of w. Every index i for which the decomposed word is known to
+ * disagree with the hypothesis yields a new counterexample; the shortest one
+ * is stored in w.
+ */
+static bool decompose(Seq &w, bool hypAnswer, const DFAView &dfa, Oracle &oracle)
+{
+	std::vector<Seq> acc;
+	dfa.accessSequences(acc);
+
+	Seq states;
+	dfa.run(w, states);
+
+	size_t n = w.size();
+	size_t bestLen = n;
+	Seq best;
+
+	Seq decomposed;
+	bool answer;
+
+	// Index n: the access sequence of the final state alone
+	if (!dfa.reachable(acc, states[n])) {
+		return false;
+	}
+	if (!oracle.lookup(acc[states[n]], answer)) {
+		return false;
+	}
+	if (answer != hypAnswer) {
+		if (acc[states[n]].size() < bestLen) {
+			w = acc[states[n]];
+			return true;
+		}
+		return false;
+	}
+
+	size_t lo = 0, hi = n;
+	while (hi - lo > 1) {
+		size_t mid = lo + (hi - lo)/2;
+		int q = states[mid];
+		if (!dfa.reachable(acc, q)) {
+			break;
+		}
+		decomposed.assign(acc[q].begin(), acc[q].end());
+		decomposed.insert(decomposed.end(), w.begin() + mid, w.end());
+		if (!oracle.lookup(decomposed, answer)) {
+			break;
+		}
+		if (answer != hypAnswer) {
+			lo = mid;
+			if (decomposed.size() < bestLen) {
+				bestLen = decomposed.size();
+				best.swap(decomposed);
+			}
+		}
+		else {
+			hi = mid;
+		}
+	}
+
+	if (bestLen < n) {
+		w.swap(best);
+		return true;
+	}
+	return false;
+}
+
+/*
+ * Cuts out loops in the run of the hypothesis on w. Cutting a loop does not
+ * change the output of the hypothesis, so the shorter word is a
+ * counterexample whenever its known answer still disagrees with it.
+ */
+static bool removeLoops(Seq &w, bool hypAnswer, const DFAView &dfa, Oracle &oracle)
+{
+	bool changed = false;
+	// Bound the number of lookups, as every attempt costs a knowledgebase
+	// traversal linear in the word length.
+	size_t budget = 2 * w.size() + 16;
+
+	Seq states;
+	Seq candidate;
+	bool cut = true;
+	while (cut && budget) {
+		cut = false;
+		dfa.run(w, states);
+		std::map<int, size_t> firstOcc;
+		for (size_t j = 0; j < states.size() && budget; j++) {
+			std::pair<std::map<int, size_t>::iterator, bool> ins = firstOcc.insert(std::make_pair(states[j], j));
+			if (ins.second) {
+				continue;
+			}
+			size_t i = ins.first->second;
+			candidate.assign(w.begin(), w.begin() + i);
+			candidate.insert(candidate.end(), w.begin() + j, w.end());
+			budget--;
+			bool answer;
+			if (oracle.lookup(candidate, answer) && answer != hypAnswer) {
+				w.swap(candidate);
+				changed = cut = true;
+				break;
+			}
+		}
+	}
+
+	return changed;
+}
+
+bool shortenDFA(std::list<int> &ce, const FlatAutomaton &hyp,
+		const libalf::knowledgebase<bool> &kb, Stats &stats)
+{
+	size_t origLen = ce.size();
+	stats.counterExamples++;
+	stats.symbolsIn += origLen;
+
+	if (hyp.initialStates().size() != 1) {
+		stats.symbolsOut += origLen;
+		return false;
+	}
+
+	DFAView dfa(hyp);
+	Oracle oracle(kb, stats);
+
+	Seq w(ce.begin(), ce.end());
+	Seq states;
+	dfa.run(w, states);
+	bool hypAnswer = dfa.accepting(states.back());
+
+	bool changed = decompose(w, hypAnswer, dfa, oracle);
+	changed |= removeLoops(w, hypAnswer, dfa, oracle);
+
+	if (changed) {
+		ce.assign(w.begin(), w.end());
+		stats.shortened++;
+	}
+	stats.symbolsOut += ce.size();
+
+	return changed;
+}
+
+};
@@ -0,0 +1,410 @@
+/* Copyright (C) 2015 TU Dortmund
+ * This file is part of LearnLib, http://www.learnlib.de/.
+ * 
+ * LearnLib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 3.0 as published by the Free Software Foundation.
+ * 
+ * LearnLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with LearnLib; if not, see
+ * <http://www.gnu.de/documents/lgpl.en.html>.
+ */
+
+// ColdAnswerStore.cpp
+// Implementation of the memory-mapped cold answer store
+
+#include <cstdio>
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "ColdAnswerStore.hpp"
+#include "Varint.hpp"
+
+namespace {
+
+const size_t WRITE_BUFFER_SIZE = 1 << 16;
+
+// Writes the records of a run file, sampling the offsets for its index
+class RecordWriter {
+public:
+	RecordWriter(std::FILE *file, std::vector<uint64_t> &index)
+		: m_file(file), m_index(index), m_count(0), m_flushed(0), m_failed(false)
+	{
+		m_buf.reserve(WRITE_BUFFER_SIZE);
+	}
+
+	void write(const ColdAnswerStore::Key &key, jint answer)
+	{
+		if (m_count++ % ColdAnswerStore::INDEX_INTERVAL == 0) {
+			m_index.push_back(position());
+		}
+		Varint::put(m_buf, key.size());
+		for (ColdAnswerStore::Key::const_iterator it = key.begin(); it != key.end(); ++it) {
+			Varint::put(m_buf, static_cast<uint32_t>(*it));
+		}
+		Varint::put(m_buf, Varint::zigZag(answer));
+		if (m_buf.size() >= WRITE_BUFFER_SIZE) {
+			flush();
+		}
+	}
+
+	uint64_t count(void) const
+	{
+		return m_count;
+	}
+
+	bool finish(void)
+	{
+		flush();
+		return !m_failed && std::fflush(m_file) == 0;
+	}
+
+private:
+	uint64_t position(void) const
+	{
+		return m_flushed + m_buf.size();
+	}
+
+	void flush(void)
+	{
+		if (!m_buf.empty() && std::fwrite(m_buf.data(), 1, m_buf.size(), m_file) != m_buf.size()) {
+			m_failed = true;
+		}
+		m_flushed += m_buf.size();
+		m_buf.clear();
+	}
+
+private:
+	std::FILE *m_file;
+	std::vector<uint64_t> &m_index;
+	std::vector<unsigned char> m_buf;
+	uint64_t m_count;
+	uint64_t m_flushed;
+	bool m_failed;
+};
+
+bool keyLess(const std::pair<ColdAnswerStore::Key, jint> &a, const std::pair<ColdAnswerStore::Key, jint> &b)
+{
+	return a.first < b.first;
+}
+
+}
+
+ColdAnswerStore::ColdAnswerStore(const std::string &path)
+	: m_path(path), m_nextRun(0)
+{}
+
+ColdAnswerStore::~ColdAnswerStore(void)
+{
+	for (std::vector<RunFile>::iterator it = m_runs.begin(); it != m_runs.end(); ++it) {
+		removeRunFile(*it);
+	}
+}
+
+jlong ColdAnswerStore::size(void) const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	uint64_t count = 0;
+	for (std::vector<RunFile>::const_iterator it = m_runs.begin(); it != m_runs.end(); ++it) {
+		count += it->count;
+	}
+	return static_cast<jlong>(count);
+}
+
+jlong ColdAnswerStore::fileBytes(void) const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	uint64_t length = 0;
+	for (std::vector<RunFile>::const_iterator it = m_runs.begin(); it != m_runs.end(); ++it) {
+		length += it->length;
+	}
+	return static_cast<jlong>(length);
+}
+
+size_t ColdAnswerStore::decode(const RunFile &file, size_t pos, Key &key, jint &answer)
+{
+	// The file has been written by this store, so it is not checked for truncation
+	const unsigned char *p = file.data + pos;
+	const unsigned char *end = file.data + file.length;
+	uint64_t len, value;
+	p = Varint::get(p, end, len);
+	key.resize(static_cast<size_t>(len));
+	for (size_t i = 0; i < key.size(); i++) {
+		p = Varint::get(p, end, value);
+		key[i] = static_cast<int32_t>(value);
+	}
+	p = Varint::get(p, end, value);
+	answer = Varint::unZigZag(value);
+	return static_cast<size_t>(p - file.data);
+}
+
+void ColdAnswerStore::newRunFile(RunFile &file)
+{
+	char suffix[32];
+	std::snprintf(suffix, sizeof(suffix), ".%llu", static_cast<unsigned long long>(m_nextRun++));
+	file.path = m_path + suffix;
+}
+
+void ColdAnswerStore::removeRunFile(RunFile &file)
+{
+	unmap(file);
+	std::remove(file.path.c_str());
+}
+
+bool ColdAnswerStore::writeRun(RunFile &file, const Run &run)
+{
+	std::FILE *out = std::fopen(file.path.c_str(), "wb");
+	if (!out) {
+		return false;
+	}
+	RecordWriter writer(out, file.index);
+	for (Run::const_iterator it = run.begin(); it != run.end(); ++it) {
+		// of equal words, the one added last is kept
+		if (it + 1 != run.end() && (it + 1)->first == it->first) {
+			continue;
+		}
+		writer.write(it->first, it->second);
+	}
+	file.count = writer.count();
+
+	bool ok = writer.finish();
+	ok = (std::fclose(out) == 0) && ok;
+	if (!ok || !map(file)) {
+		removeRunFile(file);
+		return false;
+	}
+	return true;
+}
+
+bool ColdAnswerStore::mergeRuns(const RunFile &older, const RunFile &newer, RunFile &merged)
+{
+	std::FILE *out = std::fopen(merged.path.c_str(), "wb");
+	if (!out) {
+		return false;
+	}
+	RecordWriter writer(out, merged.index);
+	Key oldKey, newKey;
+	jint oldAnswer = 0, newAnswer = 0;
+	size_t oldPos = 0, newPos = 0;
+	bool haveOld = false, haveNew = false;
+	for (;;) {
+		if (!haveOld && oldPos < older.length) {
+			oldPos = decode(older, oldPos, oldKey, oldAnswer);
+			haveOld = true;
+		}
+		if (!haveNew && newPos < newer.length) {
+			newPos = decode(newer, newPos, newKey, newAnswer);
+			haveNew = true;
+		}
+		if (haveNew && (!haveOld || newKey <= oldKey)) {
+			if (haveOld && newKey == oldKey) {
+				haveOld = false;
+			}
+			writer.write(newKey, newAnswer);
+			haveNew = false;
+		}
+		else if (haveOld) {
+			writer.write(oldKey, oldAnswer);
+			haveOld = false;
+		}
+		else {
+			break;
+		}
+	}
+	merged.count = writer.count();
+
+	bool ok = writer.finish();
+	ok = (std::fclose(out) == 0) && ok;
+	if (!ok || !map(merged)) {
+		removeRunFile(merged);
+		return false;
+	}
+	return true;
+}
+
+bool ColdAnswerStore::spill(Run &run)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (run.empty()) {
+		return true;
+	}
+	std::stable_sort(run.begin(), run.end(), keyLess);
+
+	RunFile file;
+	newRunFile(file);
+	if (!writeRun(file, run)) {
+		return false;
+	}
+	m_runs.push_back(file);
+	m_stats.spills++;
+
+	// Merges the newest runs as long as they are of similar size, like the
+	// carries of a binary counter. If a merge fails, the runs are kept as
+	// they are, and stay available.
+	while (m_runs.size() > 1 && 2 * m_runs[m_runs.size() - 1].count >= m_runs[m_runs.size() - 2].count) {
+		RunFile merged;
+		newRunFile(merged);
+		if (!mergeRuns(m_runs[m_runs.size() - 2], m_runs[m_runs.size() - 1], merged)) {
+			break;
+		}
+		removeRunFile(m_runs[m_runs.size() - 1]);
+		removeRunFile(m_runs[m_runs.size() - 2]);
+		m_runs.resize(m_runs.size() - 2);
+		m_runs.push_back(merged);
+	}
+	return true;
+}
+
+bool ColdAnswerStore::lookup(const Word &w, jint &answer)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_stats.lookups++;
+	if (!findLocked(w, answer)) {
+		return false;
+	}
+	m_stats.hits++;
+	return true;
+}
+
+bool ColdAnswerStore::find(const Word &w, jint &answer)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return findLocked(w, answer);
+}
+
+bool ColdAnswerStore::findLocked(const Word &w, jint &answer)
+{
+	if (m_runs.empty()) {
+		return false;
+	}
+	Key key(w.begin(), w.end());
+	for (std::vector<RunFile>::reverse_iterator it = m_runs.rbegin(); it != m_runs.rend(); ++it) {
+		if (findIn(*it, key, answer)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool ColdAnswerStore::findIn(const RunFile &file, const Key &key, jint &answer)
+{
+	if (!file.count) {
+		return false;
+	}
+
+	// last sampled record not greater than the key
+	size_t lo = 0, hi = file.index.size();
+	while (hi - lo > 1) {
+		size_t mid = lo + (hi - lo)/2;
+		jint ignored;
+		decode(file, static_cast<size_t>(file.index[mid]), m_scratch, ignored);
+		if (key < m_scratch) {
+			hi = mid;
+		}
+		else {
+			lo = mid;
+		}
+	}
+
+	size_t pos = static_cast<size_t>(file.index[lo]);
+	for (size_t i = 0; i < INDEX_INTERVAL && pos < file.length; i++) {
+		jint recAnswer;
+		pos = decode(file, pos, m_scratch, recAnswer);
+		if (m_scratch == key) {
+			answer = recAnswer;
+			return true;
+		}
+		if (key < m_scratch) {
+			break;
+		}
+	}
+	return false;
+}
+
+#ifdef _WIN32
+
+bool ColdAnswerStore::map(RunFile &file)
+{
+	HANDLE handle = CreateFileA(file.path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (handle == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+	LARGE_INTEGER size;
+	size.QuadPart = 0;
+	HANDLE mapping = NULL;
+	if (GetFileSizeEx(handle, &size) && size.QuadPart > 0) {
+		mapping = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+	}
+	CloseHandle(handle);
+	if (!mapping) {
+		return size.QuadPart == 0;
+	}
+	file.data = static_cast<const unsigned char *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	if (!file.data) {
+		CloseHandle(mapping);
+		return false;
+	}
+	file.mapping = mapping;
+	file.length = static_cast<size_t>(size.QuadPart);
+	return true;
+}
+
+void ColdAnswerStore::unmap(RunFile &file)
+{
+	if (file.data) {
+		UnmapViewOfFile(file.data);
+		CloseHandle(static_cast<HANDLE>(file.mapping));
+	}
+	file.data = NULL;
+	file.mapping = NULL;
+	file.length = 0;
+}
+
+#else // _WIN32
+
+bool ColdAnswerStore::map(RunFile &file)
+{
+	int fd = open(file.path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+	struct stat st;
+	st.st_size = 0;
+	void *data = MAP_FAILED;
+	if (fstat(fd, &st) == 0 && st.st_size > 0) {
+		data = mmap(NULL, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+	}
+	close(fd);
+	if (data == MAP_FAILED) {
+		return st.st_size == 0;
+	}
+	// Lookups touch few, scattered pages
+	madvise(data, static_cast<size_t>(st.st_size), MADV_RANDOM);
+	file.data = static_cast<const unsigned char *>(data);
+	file.length = static_cast<size_t>(st.st_size);
+	return true;
+}
+
+void ColdAnswerStore::unmap(RunFile &file)
+{
+	if (file.data) {
+		munmap(const_cast<unsigned char *>(file.data), file.length);
+	}
+	file.data = NULL;
+	file.length = 0;
+}
+
+#endif // _WIN32
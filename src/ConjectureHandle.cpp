@@ -0,0 +1,161 @@
+/* Copyright (C) 2015 TU Dortmund
+ * This file is part of LearnLib, http://www.learnlib.de/.
+ * 
+ * LearnLib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 3.0 as published by the Free Software Foundation.
+ * 
+ * LearnLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with LearnLib; if not, see
+ * <http://www.gnu.de/documents/lgpl.en.html>.
+ */
+
+// ConjectureHandle.cpp
+// Implementation of the conjecture handles
+
+#include <algorithm>
+#include <cstring>
+
+#include "ConjectureHandle.hpp"
+#include "SAF.hpp"
+
+// Size of the SAF header: magic, automaton type, alphabet size, state count
+static const size_t SAF_HEADER_SIZE = 12;
+
+
+ConjectureHandle::Format FAConjectureHandle::nativeFormat(void) const
+{
+	return m_fa->isDeterministic() ? DFA_FORMAT : NFA_FORMAT;
+}
+
+jlong FAConjectureHandle::numTransitions(void) const
+{
+	if (!m_fa->isDeterministic()) {
+		return static_cast<jlong>(m_fa->targets().size());
+	}
+	const std::vector<int32_t> &table = m_fa->table();
+	return static_cast<jlong>(table.size() - std::count(table.begin(), table.end(), -1));
+}
+
+const FlatAutomaton *FAConjectureHandle::view(Format format) const
+{
+	if (format == NATIVE_FORMAT || format == nativeFormat()) {
+		return m_fa.get();
+	}
+	if (format != NFA_FORMAT) {
+		return NULL;
+	}
+	if (!m_nfaView) {
+		m_nfaView.reset(new FlatAutomaton(*m_fa));
+		m_nfaView->convertToNondeterministic();
+	}
+	return m_nfaView.get();
+}
+
+bool FAConjectureHandle::computePartSize(Format format, int begin, int end, size_t &size) const
+{
+	const FlatAutomaton *fa = view(format);
+	if (!fa || !validRange(begin, end)) {
+		return false;
+	}
+	size = fa->isDeterministic() ? SAF::computeDFAPartSize(*fa, begin, end) : SAF::computeNFAPartSize(*fa, begin, end);
+	return true;
+}
+
+bool FAConjectureHandle::encodePart(Format format, int begin, int end, jbyte *buf, size_t size) const
+{
+	const FlatAutomaton *fa = view(format);
+	if (!fa || !validRange(begin, end)) {
+		return false;
+	}
+	if (fa->isDeterministic()) {
+		return SAF::encodeDFAPart(buf, size, *fa, begin, end);
+	}
+	return SAF::encodeNFAPart(buf, size, *fa, begin, end);
+}
+
+
+jlong MealyConjectureHandle::numTransitions(void) const
+{
+	const std::vector<int32_t> &table = m_mm->table();
+	return static_cast<jlong>(table.size() - std::count(table.begin(), table.end(), -1));
+}
+
+bool MealyConjectureHandle::computePartSize(Format format, int begin, int end, size_t &size) const
+{
+	if ((format != NATIVE_FORMAT && format != MEALY_FORMAT) || !validRange(begin, end)) {
+		return false;
+	}
+	size = SAF::computeMealyPartSize(*m_mm, begin, end);
+	return true;
+}
+
+bool MealyConjectureHandle::encodePart(Format format, int begin, int end, jbyte *buf, size_t size) const
+{
+	if ((format != NATIVE_FORMAT && format != MEALY_FORMAT) || !validRange(begin, end)) {
+		return false;
+	}
+	return SAF::encodeMealyPart(buf, size, *m_mm, begin, end);
+}
+
+
+EncodedConjectureHandle::EncodedConjectureHandle(std::vector<jbyte> &encoding)
+{
+	m_encoding.swap(encoding);
+}
+
+jint EncodedConjectureHandle::readInt32(size_t pos) const
+{
+	if (m_encoding.size() < pos + 4) {
+		return 0;
+	}
+	// SAF integers are big-endian
+	uint32_t value = 0;
+	for (size_t i = 0; i < 4; i++) {
+		value = (value << 8) | static_cast<unsigned char>(m_encoding[pos + i]);
+	}
+	return static_cast<jint>(value);
+}
+
+ConjectureHandle::Format EncodedConjectureHandle::nativeFormat(void) const
+{
+	return (m_encoding.size() < SAF_HEADER_SIZE) ? NATIVE_FORMAT : static_cast<Format>(m_encoding[3]);
+}
+
+int EncodedConjectureHandle::alphabetSize(void) const
+{
+	return readInt32(4);
+}
+
+int EncodedConjectureHandle::numStates(void) const
+{
+	return readInt32(8);
+}
+
+bool EncodedConjectureHandle::isFull(Format format, int begin, int end) const
+{
+	return ((format == NATIVE_FORMAT || format == nativeFormat()) && begin == 0 && end == numStates());
+}
+
+bool EncodedConjectureHandle::computePartSize(Format format, int begin, int end, size_t &size) const
+{
+	if (!isFull(format, begin, end)) {
+		return false;
+	}
+	size = m_encoding.size();
+	return true;
+}
+
+bool EncodedConjectureHandle::encodePart(Format format, int begin, int end, jbyte *buf, size_t size) const
+{
+	if (!isFull(format, begin, end) || size < m_encoding.size()) {
+		return false;
+	}
+	std::memcpy(buf, m_encoding.data(), m_encoding.size());
+	return true;
+}
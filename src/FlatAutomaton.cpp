@@ -0,0 +1,171 @@
+/* Copyright (C) 2015 TU Dortmund
+ * This file is part of LearnLib, http://www.learnlib.de/.
+ *
+ * LearnLib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 3.0 as published by the Free Software Foundation.
+ *
+ * LearnLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with LearnLib; if not, see
+ * <http://www.gnu.de/documents/lgpl.en.html>.
+ */
+
+// FlatAutomaton.cpp
+// Conversion of libalf finite automata and Moore machines into the flat
+// representation
+
+#include <map>
+#include <set>
+
+#include "FlatAutomaton.hpp"
+
+typedef std::map<int, std::set<int> > StateTransitions;
+typedef std::map<int, StateTransitions > Transitions;
+
+FlatAutomaton::FlatAutomaton(const libalf::finite_automaton &fa, bool deterministic)
+	: m_deterministic(deterministic),
+	  m_alphabetSize(fa.input_alphabet_size),
+	  m_numStates(fa.state_count),
+	  m_initial(fa.initial_states.begin(), fa.initial_states.end()),
+	  m_acceptance((fa.state_count - 1)/32 + 1, 0)
+{
+	for (std::map<int, bool>::const_iterator it = fa.output_mapping.begin(); it != fa.output_mapping.end(); ++it) {
+		int state = it->first;
+		if (state >= 0 && state < m_numStates && it->second) {
+			m_acceptance[state / 32] |= static_cast<uint32_t>(1) << (state % 32);
+		}
+	}
+
+	if (deterministic) {
+		initDFATransitions(fa);
+	}
+	else {
+		initNFATransitions(fa);
+	}
+}
+
+FlatAutomaton::FlatAutomaton(int alphabetSize, int numStates, int initial,
+		std::vector<uint32_t> &acceptance, std::vector<int32_t> &table)
+	: m_deterministic(true),
+	  m_alphabetSize(alphabetSize),
+	  m_numStates(numStates),
+	  m_initial(1, initial)
+{
+	m_acceptance.swap(acceptance);
+	m_acceptance.resize((numStates - 1)/32 + 1, 0);
+	m_table.swap(table);
+}
+
+void FlatAutomaton::convertToNondeterministic(void)
+{
+	if (!m_deterministic) {
+		return;
+	}
+	size_t numCells = m_table.size();
+	m_offsets.resize(numCells + 1);
+	m_targets.clear();
+	m_targets.reserve(numCells);
+	for (size_t i = 0; i < numCells; i++) {
+		m_offsets[i] = static_cast<int32_t>(m_targets.size());
+		if (m_table[i] >= 0) {
+			m_targets.push_back(m_table[i]);
+		}
+	}
+	m_offsets[numCells] = static_cast<int32_t>(m_targets.size());
+	std::vector<int32_t>().swap(m_table);
+	m_deterministic = false;
+}
+
+void FlatAutomaton::initDFATransitions(const libalf::finite_automaton &fa)
+{
+	m_table.assign(static_cast<size_t>(m_numStates) * m_alphabetSize, -1);
+
+	for (Transitions::const_iterator it = fa.transitions.begin(); it != fa.transitions.end(); ++it) {
+		int state = it->first;
+		if (state < 0 || state >= m_numStates) {
+			continue;
+		}
+		int32_t *row = &m_table[static_cast<size_t>(state) * m_alphabetSize];
+		const StateTransitions &strans = it->second;
+		for (StateTransitions::const_iterator sit = strans.begin(); sit != strans.end(); ++sit) {
+			int sym = sit->first;
+			if (sym < 0 || sym >= m_alphabetSize || sit->second.empty()) {
+				continue;
+			}
+			row[sym] = *sit->second.begin();
+		}
+	}
+}
+
+void FlatAutomaton::initNFATransitions(const libalf::finite_automaton &fa)
+{
+	size_t numCells = static_cast<size_t>(m_numStates) * m_alphabetSize;
+	m_offsets.reserve(numCells + 1);
+	m_offsets.push_back(0);
+
+	// The transition maps are ordered by state and symbol, so the rows can
+	// be filled in a single pass, padding the cells without transitions.
+	for (Transitions::const_iterator it = fa.transitions.begin(); it != fa.transitions.end(); ++it) {
+		int state = it->first;
+		if (state < 0 || state >= m_numStates) {
+			continue;
+		}
+		size_t rowStart = static_cast<size_t>(state) * m_alphabetSize;
+		const StateTransitions &strans = it->second;
+		for (StateTransitions::const_iterator sit = strans.begin(); sit != strans.end(); ++sit) {
+			int sym = sit->first;
+			if (sym < 0 || sym >= m_alphabetSize) {
+				continue;
+			}
+			m_offsets.resize(rowStart + sym + 1, static_cast<int32_t>(m_targets.size()));
+			m_targets.insert(m_targets.end(), sit->second.begin(), sit->second.end());
+			m_offsets.push_back(static_cast<int32_t>(m_targets.size()));
+		}
+	}
+	m_offsets.resize(numCells + 1, static_cast<int32_t>(m_targets.size()));
+}
+
+
+FlatMealyMachine::FlatMealyMachine(const libalf::moore_machine<int> &mm)
+	: m_alphabetSize(mm.input_alphabet_size),
+	  m_numStates(mm.state_count),
+	  m_initial(mm.initial_states.empty() ? 0 : *mm.initial_states.begin()),
+	  m_table(static_cast<size_t>(mm.state_count) * mm.input_alphabet_size, -1),
+	  m_outputs(m_table.size(), 0)
+{
+	for (Transitions::const_iterator it = mm.transitions.begin(); it != mm.transitions.end(); ++it) {
+		int state = it->first;
+		if (state < 0 || state >= m_numStates) {
+			continue;
+		}
+		size_t rowStart = static_cast<size_t>(state) * m_alphabetSize;
+		const StateTransitions &strans = it->second;
+		for (StateTransitions::const_iterator sit = strans.begin(); sit != strans.end(); ++sit) {
+			int sym = sit->first;
+			if (sym < 0 || sym >= m_alphabetSize || sit->second.empty()) {
+				continue;
+			}
+			int target = *sit->second.begin();
+			std::map<int, int>::const_iterator out = mm.output_mapping.find(target);
+			if (out != mm.output_mapping.end()) {
+				m_table[rowStart + sym] = target;
+				m_outputs[rowStart + sym] = out->second;
+			}
+		}
+	}
+}
+
+FlatMealyMachine::FlatMealyMachine(int alphabetSize, int numStates, int initial,
+		std::vector<int32_t> &table, std::vector<int32_t> &outputs)
+	: m_alphabetSize(alphabetSize),
+	  m_numStates(numStates),
+	  m_initial(initial)
+{
+	m_table.swap(table);
+	m_outputs.swap(outputs);
+}
@@ -0,0 +1,243 @@
+/* Copyright (C) 2015 TU Dortmund
+ * This file is part of LearnLib, http://www.learnlib.de/.
+ * 
+ * LearnLib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 3.0 as published by the Free Software Foundation.
+ * 
+ * LearnLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with LearnLib; if not, see
+ * <http://www.gnu.de/documents/lgpl.en.html>.
+ */
+
+// HypothesisDiff.cpp
+// Implementation of the product exploration of two hypotheses
+
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+
+#include "HypothesisDiff.hpp"
+
+namespace HypothesisDiff {
+
+// Number of product states expanded between two budget checks
+static const size_t BUDGET_CHECK_INTERVAL = 1024;
+
+namespace {
+
+typedef std::vector<int32_t> StateSet;
+
+/*
+ * Product states of two DFAs, with -1 denoting the rejecting sink reached
+ * via undefined transitions.
+ */
+class DFAProduct {
+public:
+	typedef uint64_t Key;
+	typedef std::hash<uint64_t> Hash;
+
+	DFAProduct(const FlatAutomaton &a, const FlatAutomaton &b) : m_a(a), m_b(b) {}
+
+	Key initial(void) const
+	{
+		return makeKey(initialOf(m_a), initialOf(m_b));
+	}
+
+	Key successor(const Key &key, int sym) const
+	{
+		return makeKey(successorOf(m_a, first(key), sym), successorOf(m_b, second(key), sym));
+	}
+
+	bool distinguishes(const Key &key) const
+	{
+		return acceptingOf(m_a, first(key)) != acceptingOf(m_b, second(key));
+	}
+
+private:
+	static Key makeKey(int32_t qa, int32_t qb)
+	{
+		return (static_cast<uint64_t>(static_cast<uint32_t>(qa)) << 32) | static_cast<uint32_t>(qb);
+	}
+	static int32_t first(Key key) { return static_cast<int32_t>(key >> 32); }
+	static int32_t second(Key key) { return static_cast<int32_t>(key & 0xffffffffu); }
+
+	static int32_t initialOf(const FlatAutomaton &fa)
+	{
+		return fa.initialStates().empty() ? -1 : fa.initialStates().front();
+	}
+	static int32_t successorOf(const FlatAutomaton &fa, int32_t q, int sym)
+	{
+		return (q < 0) ? -1 : fa.successor(q, sym);
+	}
+	static bool acceptingOf(const FlatAutomaton &fa, int32_t q)
+	{
+		return (q >= 0 && fa.isAccepting(q));
+	}
+
+private:
+	const FlatAutomaton &m_a;
+	const FlatAutomaton &m_b;
+};
+
+struct StateSetHash {
+	size_t operator()(const StateSet &s) const
+	{
+		uint64_t h = 14695981039346656037ull;
+		for (StateSet::const_iterator it = s.begin(); it != s.end(); ++it) {
+			h = (h ^ static_cast<uint32_t>(*it)) * 1099511628211ull;
+		}
+		return static_cast<size_t>(h);
+	}
+};
+
+/*
+ * Product states of the subset constructions of two NFAs. A key holds the
+ * size of the subset of the first automaton, followed by both sorted
+ * subsets.
+ */
+class NFAProduct {
+public:
+	typedef StateSet Key;
+	typedef StateSetHash Hash;
+
+	NFAProduct(const FlatAutomaton &a, const FlatAutomaton &b) : m_a(a), m_b(b) {}
+
+	Key initial(void) const
+	{
+		StateSet sa(m_a.initialStates()), sb(m_b.initialStates());
+		normalize(sa);
+		normalize(sb);
+		return makeKey(sa, sb);
+	}
+
+	Key successor(const Key &key, int sym) const
+	{
+		Key::const_iterator mid = key.begin() + 1 + key[0];
+		StateSet sa, sb;
+		successors(m_a, key.begin() + 1, mid, sym, sa);
+		successors(m_b, mid, key.end(), sym, sb);
+		return makeKey(sa, sb);
+	}
+
+	bool distinguishes(const Key &key) const
+	{
+		Key::const_iterator mid = key.begin() + 1 + key[0];
+		return accepting(m_a, key.begin() + 1, mid) != accepting(m_b, mid, key.end());
+	}
+
+private:
+	static void normalize(StateSet &s)
+	{
+		std::sort(s.begin(), s.end());
+		s.erase(std::unique(s.begin(), s.end()), s.end());
+	}
+
+	static Key makeKey(const StateSet &sa, const StateSet &sb)
+	{
+		Key key;
+		key.reserve(1 + sa.size() + sb.size());
+		key.push_back(static_cast<int32_t>(sa.size()));
+		key.insert(key.end(), sa.begin(), sa.end());
+		key.insert(key.end(), sb.begin(), sb.end());
+		return key;
+	}
+
+	static void successors(const FlatAutomaton &fa, Key::const_iterator begin, Key::const_iterator end,
+			int sym, StateSet &out)
+	{
+		const std::vector<int32_t> &offsets = fa.offsets();
+		const std::vector<int32_t> &targets = fa.targets();
+		for (Key::const_iterator it = begin; it != end; ++it) {
+			size_t cell = static_cast<size_t>(*it) * fa.alphabetSize() + sym;
+			out.insert(out.end(), targets.begin() + offsets[cell], targets.begin() + offsets[cell + 1]);
+		}
+		normalize(out);
+	}
+
+	static bool accepting(const FlatAutomaton &fa, Key::const_iterator begin, Key::const_iterator end)
+	{
+		for (Key::const_iterator it = begin; it != end; ++it) {
+			if (fa.isAccepting(*it)) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+private:
+	const FlatAutomaton &m_a;
+	const FlatAutomaton &m_b;
+};
+
+}
+
+template<class Product>
+static Result explore(const Product &product, int alphabetSize, size_t maxWords,
+		QueryBatch &words, Stats &stats, const Budget *budget)
+{
+	typedef typename Product::Key Key;
+	typedef std::unordered_map<Key, size_t, typename Product::Hash> Index;
+
+	// Product states in breadth-first order, with their BFS tree edges
+	Index index;
+	std::vector<const Key *> states;
+	std::vector<size_t> parent;
+	std::vector<int> parentSym;
+
+	std::pair<typename Index::iterator, bool> ins = index.insert(std::make_pair(product.initial(), 0));
+	states.push_back(&ins.first->first);
+	parent.push_back(0);
+	parentSym.push_back(-1);
+
+	for (size_t i = 0; i < states.size(); i++) {
+		if (budget && i % BUDGET_CHECK_INTERVAL == 0 && budget->expired()) {
+			return TIMED_OUT;
+		}
+
+		const Key &key = *states[i];
+		if (product.distinguishes(key)) {
+			stats.distinguishingStates++;
+			words.push_back(Word());
+			Word &w = words.back();
+			for (size_t j = i; j != 0; j = parent[j]) {
+				w.push_front(parentSym[j]);
+			}
+			if (maxWords && words.size() >= maxWords) {
+				break;
+			}
+		}
+
+		for (int a = 0; a < alphabetSize; a++) {
+			ins = index.insert(std::make_pair(product.successor(key, a), states.size()));
+			if (ins.second) {
+				states.push_back(&ins.first->first);
+				parent.push_back(i);
+				parentSym.push_back(a);
+			}
+		}
+	}
+
+	stats.productStates = static_cast<jlong>(states.size());
+	return OK;
+}
+
+Result compare(const FlatAutomaton &oldHyp, const FlatAutomaton &newHyp, size_t maxWords,
+		QueryBatch &words, Stats &stats, const Budget *budget)
+{
+	int alphabetSize = std::min(oldHyp.alphabetSize(), newHyp.alphabetSize());
+	if (oldHyp.isDeterministic() && newHyp.isDeterministic()) {
+		return explore(DFAProduct(oldHyp, newHyp), alphabetSize, maxWords, words, stats, budget);
+	}
+	if (!oldHyp.isDeterministic() && !newHyp.isDeterministic()) {
+		return explore(NFAProduct(oldHyp, newHyp), alphabetSize, maxWords, words, stats, budget);
+	}
+	return UNAVAILABLE;
+}
+
+};
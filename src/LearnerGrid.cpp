@@ -0,0 +1,449 @@
+/* Copyright (C) 2015 TU Dortmund
+ * This file is part of LearnLib, http://www.learnlib.de/.
+ * 
+ * LearnLib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 3.0 as published by the Free Software Foundation.
+ * 
+ * LearnLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with LearnLib; if not, see
+ * <http://www.gnu.de/documents/lgpl.en.html>.
+ */
+
+// LearnerGrid.cpp
+// Implementation of the LearnerGrid class, and JNI method implementations
+// for the LearnerGrid class
+
+#include <chrono>
+#include <memory>
+
+#include "LearnerGrid.hpp"
+#include "ThreadPool.hpp"
+#include "WordCodec.hpp"
+#include "JNIUtil.hpp"
+
+LearnerGrid::LearnerGrid(const LibAlf &libalf, size_t specLen, const jint *spec)
+{
+	const jint *p = spec;
+	const jint *end = spec + specLen;
+	if (p == end || *p < 0) {
+		return;
+	}
+	size_t numLearners = static_cast<size_t>(*p++);
+	m_entries.resize(numLearners);
+
+	for (size_t i = 0; i < numLearners; i++) {
+		if (end - p < 3) {
+			break;
+		}
+		jint algorithmId = *p++;
+		jint alphabetSize = *p++;
+		jint numOpts = *p++;
+		if (numOpts < 0 || end - p < numOpts) {
+			break;
+		}
+		// createLearner does not modify the options
+		jint *opts = numOpts ? const_cast<jint *>(p) : NULL;
+		p += numOpts;
+
+		Entry &entry = m_entries[i];
+		entry.learner = libalf.createLearner(algorithmId, alphabetSize, static_cast<size_t>(numOpts), opts);
+		if (entry.learner) {
+			entry.status = READY;
+		}
+	}
+}
+
+LearnerGrid::~LearnerGrid(void)
+{
+	for (std::vector<Entry>::iterator it = m_entries.begin(); it != m_entries.end(); ++it) {
+		delete it->pending;
+		delete it->learner;
+	}
+}
+
+bool LearnerGrid::setOracle(size_t i, MembershipOracle *oracle)
+{
+	if (i >= m_entries.size() || !m_entries[i].learner) {
+		return false;
+	}
+	m_entries[i].oracle = oracle;
+	return true;
+}
+
+void LearnerGrid::encodeConjecture(Entry &entry)
+{
+	LibalfLearner &learner = *entry.learner;
+	entry.conjecture.resize(learner.computeConjectureSize());
+	if (!learner.encodeConjecture(entry.conjecture.data(), entry.conjecture.size())) {
+		entry.conjecture.clear();
+		learner.budget().acknowledge();
+		entry.status = TIMED_OUT;
+		return;
+	}
+	entry.stats.conjectures++;
+	entry.status = CONJECTURE;
+}
+
+void LearnerGrid::advance(Entry &entry)
+{
+	typedef std::chrono::steady_clock Clock;
+
+	LibalfLearner &learner = *entry.learner;
+	entry.conjecture.clear();
+
+	for (;;) {
+		if (learner.budget().expired()) {
+			learner.budget().acknowledge();
+			entry.status = TIMED_OUT;
+			return;
+		}
+
+		entry.stats.rounds++;
+		Clock::time_point start = Clock::now();
+		bool haveConjecture = learner.advance();
+		entry.stats.advanceNanos += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+
+		if (haveConjecture) {
+			encodeConjecture(entry);
+			return;
+		}
+
+		QueryBatch *batch = learner.getQueries();
+		if (batch->empty()) {
+			delete batch;
+			entry.status = STALLED;
+			return;
+		}
+		entry.stats.queries += batch->size();
+
+		if (!entry.oracle) {
+			entry.pending = batch;
+			entry.status = QUERIES;
+			return;
+		}
+
+		entry.oracle->processQueries(learner, *batch);
+		delete batch;
+	}
+}
+
+void LearnerGrid::advanceAll(void)
+{
+	std::vector<Entry *> todo;
+	for (std::vector<Entry>::iterator it = m_entries.begin(); it != m_entries.end(); ++it) {
+		Status status = it->status;
+		if (status == READY || status == TIMED_OUT || status == STALLED) {
+			todo.push_back(&*it);
+		}
+	}
+
+	std::shared_ptr<ThreadPool> pool = ThreadPool::shared();
+	pool->parallelFor(todo.size(), [&](size_t i) {
+		advance(*todo[i]);
+	});
+}
+
+size_t LearnerGrid::computeQueriesSize(void) const
+{
+	size_t size = 1;
+	for (std::vector<Entry>::const_iterator it = m_entries.begin(); it != m_entries.end(); ++it) {
+		if (it->status == QUERIES) {
+			size += 1 + WordCodec::encodedBatchSize(*it->pending);
+		}
+	}
+	return size;
+}
+
+void LearnerGrid::encodeQueries(jint *buf) const
+{
+	jint *numLearners = buf++;
+	*numLearners = 0;
+	for (size_t i = 0; i < m_entries.size(); i++) {
+		const Entry &entry = m_entries[i];
+		if (entry.status == QUERIES) {
+			(*numLearners)++;
+			*buf++ = static_cast<jint>(i);
+			buf = WordCodec::encodeBatch(buf, *entry.pending);
+		}
+	}
+}
+
+bool LearnerGrid::processAnswers(size_t numAnswers, const jint *answers)
+{
+	std::vector<Entry *> todo;
+	std::vector<const jint *> offsets;
+	size_t total = 0;
+	for (std::vector<Entry>::iterator it = m_entries.begin(); it != m_entries.end(); ++it) {
+		if (it->status == QUERIES) {
+			todo.push_back(&*it);
+			offsets.push_back(answers + total);
+			total += it->pending->size();
+		}
+	}
+	if (total != numAnswers) {
+		return false;
+	}
+
+	std::shared_ptr<ThreadPool> pool = ThreadPool::shared();
+	pool->parallelFor(todo.size(), [&](size_t i) {
+		Entry &entry = *todo[i];
+		entry.learner->addEncodedAnswers(*entry.pending, offsets[i]);
+		delete entry.pending;
+		entry.pending = NULL;
+		entry.status = READY;
+	});
+
+	return true;
+}
+
+bool LearnerGrid::addCounterExamples(size_t encLen, const jint *enc)
+{
+	const jint *p = enc;
+	const jint *end = enc + encLen;
+	if (p == end || *p < 0) {
+		return false;
+	}
+	size_t numCEs = static_cast<size_t>(*p++);
+	// Every counterexample takes at least its learner index and length
+	if (numCEs > static_cast<size_t>(end - p) / 2) {
+		return false;
+	}
+
+	// The counterexamples are grouped by learner, as a learner must not be
+	// used by several tasks at once
+	std::vector<Entry *> todo;
+	std::vector<QueryBatch> ces;
+	std::vector<size_t> groups(m_entries.size(), static_cast<size_t>(-1));
+	for (size_t i = 0; i < numCEs; i++) {
+		if (p == end) {
+			return false;
+		}
+		jint idx = *p++;
+		if (idx < 0 || static_cast<size_t>(idx) >= m_entries.size() || m_entries[idx].status != CONJECTURE) {
+			return false;
+		}
+		size_t &group = groups[idx];
+		if (group == static_cast<size_t>(-1)) {
+			group = todo.size();
+			todo.push_back(&m_entries[idx]);
+			ces.push_back(QueryBatch());
+		}
+		ces[group].push_back(Word());
+		p = WordCodec::decodeWord(p, end, ces[group].back());
+		if (!p) {
+			return false;
+		}
+	}
+
+	std::shared_ptr<ThreadPool> pool = ThreadPool::shared();
+	pool->parallelFor(todo.size(), [&](size_t i) {
+		Entry &entry = *todo[i];
+		for (QueryBatch::iterator it = ces[i].begin(); it != ces[i].end(); ++it) {
+			entry.learner->addCounterExample(*it);
+		}
+		entry.status = READY;
+	});
+
+	return true;
+}
+
+// JNI native methods
+
+extern "C" {
+
+/*
+ * Class:     de_learnlib_libalf_LearnerGrid
+ * Method:    init
+ * Signature: ([B[I)[B
+ */
+JNIEXPORT jbyteArray JNICALL Java_de_learnlib_libalf_LearnerGrid_init
+  (JNIEnv *env, jclass clazz, jbyteArray jptr, jintArray jSpec)
+{
+	LibAlf &instance = JNIUtil::extractRef<LibAlf>(env, jptr);
+
+	std::vector<jint> spec(env->GetArrayLength(jSpec));
+	env->GetIntArrayRegion(jSpec, 0, spec.size(), spec.data());
+
+	LearnerGrid *grid = new LearnerGrid(instance, spec.size(), spec.data());
+
+	return JNIUtil::createPtr(env, grid);
+}
+
+/*
+ * Class:     de_learnlib_libalf_LearnerGrid
+ * Method:    dispose
+ * Signature: ([B)V
+ */
+JNIEXPORT void JNICALL Java_de_learnlib_libalf_LearnerGrid_dispose
+  (JNIEnv *env, jclass clazz, jbyteArray ptr)
+{
+	LearnerGrid *grid = JNIUtil::extractPtr<LearnerGrid>(env, ptr);
+	delete grid;
+}
+
+/*
+ * Class:     de_learnlib_libalf_LearnerGrid
+ * Method:    setOracle
+ * Signature: ([BI[B)Z
+ */
+JNIEXPORT jboolean JNICALL Java_de_learnlib_libalf_LearnerGrid_setOracle
+  (JNIEnv *env, jclass clazz, jbyteArray ptr, jint learnerIdx, jbyteArray oraclePtr)
+{
+	LearnerGrid &grid = JNIUtil::extractRef<LearnerGrid>(env, ptr);
+	MembershipOracle *oracle = JNIUtil::extractPtr<MembershipOracle>(env, oraclePtr);
+
+	if (learnerIdx < 0) {
+		return JNI_FALSE;
+	}
+	return grid.setOracle(static_cast<size_t>(learnerIdx), oracle) ? JNI_TRUE : JNI_FALSE;
+}
+
+/*
+ * Class:     de_learnlib_libalf_LearnerGrid
+ * Method:    advanceAll
+ * Signature: ([B)[I
+ */
+JNIEXPORT jintArray JNICALL Java_de_learnlib_libalf_LearnerGrid_advanceAll
+  (JNIEnv *env, jclass clazz, jbyteArray ptr)
+{
+	LearnerGrid &grid = JNIUtil::extractRef<LearnerGrid>(env, ptr);
+	grid.advanceAll();
+
+	std::vector<jint> status(grid.size());
+	for (size_t i = 0; i < grid.size(); i++) {
+		status[i] = static_cast<jint>(grid.status(i));
+	}
+
+	jintArray result = env->NewIntArray(status.size());
+	if (!result) {
+		return NULL;
+	}
+	env->SetIntArrayRegion(result, 0, status.size(), status.data());
+
+	return result;
+}
+
+/*
+ * Class:     de_learnlib_libalf_LearnerGrid
+ * Method:    getQueries
+ * Signature: ([B)[I
+ */
+JNIEXPORT jintArray JNICALL Java_de_learnlib_libalf_LearnerGrid_getQueries
+  (JNIEnv *env, jclass clazz, jbyteArray ptr)
+{
+	LearnerGrid &grid = JNIUtil::extractRef<LearnerGrid>(env, ptr);
+
+	size_t totalSpace = grid.computeQueriesSize();
+	jintArray result = env->NewIntArray(totalSpace);
+	if (!result) {
+		return NULL;
+	}
+	jint *queriesEnc = static_cast<jint *>(env->GetPrimitiveArrayCritical(result, NULL));
+	grid.encodeQueries(queriesEnc);
+	env->ReleasePrimitiveArrayCritical(result, queriesEnc, 0);
+
+	return result;
+}
+
+/*
+ * Class:     de_learnlib_libalf_LearnerGrid
+ * Method:    processAnswers
+ * Signature: ([B[I)Z
+ */
+JNIEXPORT jboolean JNICALL Java_de_learnlib_libalf_LearnerGrid_processAnswers
+  (JNIEnv *env, jclass clazz, jbyteArray ptr, jintArray jAnswers)
+{
+	LearnerGrid &grid = JNIUtil::extractRef<LearnerGrid>(env, ptr);
+
+	// Copy the answers, as they are processed by several native threads
+	std::vector<jint> answers(env->GetArrayLength(jAnswers));
+	env->GetIntArrayRegion(jAnswers, 0, answers.size(), answers.data());
+
+	return grid.processAnswers(answers.size(), answers.data()) ? JNI_TRUE : JNI_FALSE;
+}
+
+/*
+ * Class:     de_learnlib_libalf_LearnerGrid
+ * Method:    addCounterExamples
+ * Signature: ([B[I)Z
+ */
+JNIEXPORT jboolean JNICALL Java_de_learnlib_libalf_LearnerGrid_addCounterExamples
+  (JNIEnv *env, jclass clazz, jbyteArray ptr, jintArray jCEs)
+{
+	LearnerGrid &grid = JNIUtil::extractRef<LearnerGrid>(env, ptr);
+
+	std::vector<jint> ces(env->GetArrayLength(jCEs));
+	env->GetIntArrayRegion(jCEs, 0, ces.size(), ces.data());
+
+	return grid.addCounterExamples(ces.size(), ces.data()) ? JNI_TRUE : JNI_FALSE;
+}
+
+/*
+ * Class:     de_learnlib_libalf_LearnerGrid
+ * Method:    getConjectures
+ * Signature: ([B)[[B
+ */
+JNIEXPORT jobjectArray JNICALL Java_de_learnlib_libalf_LearnerGrid_getConjectures
+  (JNIEnv *env, jclass clazz, jbyteArray ptr)
+{
+	LearnerGrid &grid = JNIUtil::extractRef<LearnerGrid>(env, ptr);
+
+	jclass byteArrayClazz = env->FindClass("[B");
+	jobjectArray result = env->NewObjectArray(grid.size(), byteArrayClazz, NULL);
+	if (!result) {
+		return NULL;
+	}
+
+	for (size_t i = 0; i < grid.size(); i++) {
+		if (grid.status(i) != LearnerGrid::CONJECTURE) {
+			continue;
+		}
+		const std::vector<jbyte> &cj = grid.conjecture(i);
+		jbyteArray cjEnc = env->NewByteArray(cj.size());
+		if (!cjEnc) {
+			return NULL;
+		}
+		env->SetByteArrayRegion(cjEnc, 0, cj.size(), cj.data());
+		env->SetObjectArrayElement(result, i, cjEnc);
+		env->DeleteLocalRef(cjEnc);
+	}
+
+	return result;
+}
+
+/*
+ * Class:     de_learnlib_libalf_LearnerGrid
+ * Method:    getStats
+ * Signature: ([B)[J
+ */
+JNIEXPORT jlongArray JNICALL Java_de_learnlib_libalf_LearnerGrid_getStats
+  (JNIEnv *env, jclass clazz, jbyteArray ptr)
+{
+	LearnerGrid &grid = JNIUtil::extractRef<LearnerGrid>(env, ptr);
+
+	std::vector<jlong> statsEnc;
+	statsEnc.reserve(grid.size() * LearnerGrid::NUM_STATS);
+	for (size_t i = 0; i < grid.size(); i++) {
+		const LearnerGrid::Stats &stats = grid.stats(i);
+		statsEnc.push_back(stats.rounds);
+		statsEnc.push_back(stats.queries);
+		statsEnc.push_back(stats.conjectures);
+		statsEnc.push_back(stats.advanceNanos);
+	}
+
+	jlongArray result = env->NewLongArray(statsEnc.size());
+	if (!result) {
+		return NULL;
+	}
+	env->SetLongArrayRegion(result, 0, statsEnc.size(), statsEnc.data());
+
+	return result;
+}
+
+};
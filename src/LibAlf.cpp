@@ -21,11 +21,15 @@
 
 #include <map>
 #include <list>
+#include <vector>
 #include <cstring>
 
 #include "LibAlf.hpp"
 #include "LibalfLearner.hpp"
 #include "JNIUtil.hpp"
+#include "ThreadPool.hpp"
+#include "RemoteLearner.hpp"
+#include "SessionLog.hpp"
 
 #include <libalf/algorithm_angluin.h>
 #include <libalf/algorithm_kearns_vazirani.h>
@@ -55,8 +59,10 @@ public:
 	}
 };
 
-#define DEFINE_LEARNER(name, type, alfClass, ...) \
+#define DEFINE_LEARNER_CLASS(name, type, active, alfClass, ...) \
 class name ## Learner : public Libalf ## type ## Learner<name ## Learner> { \
+public: \
+	static const bool ACTIVE = active; \
 public: \
 	static LibalfLearner *init(jint alphabetSize, size_t otherOptsLen, jint *otherOptions) \
 	{ \
@@ -64,13 +70,28 @@ public: \
 	} \
 public: \
 	name ## Learner(int alphabetSize, size_t otherOptsLen, jint *otherOptions) \
-		: m_algorithm(&m_kb, NULL, alphabetSize, ##__VA_ARGS__) \
+		: m_alphabetSize(alphabetSize), \
+		  m_otherOptions(otherOptions, otherOptions + otherOptsLen), \
+		  m_algorithm(&m_kb, NULL, alphabetSize, ##__VA_ARGS__) \
 	{} \
+	name ## Learner *createSibling(void) const \
+	{ \
+		std::vector<jint> otherOptions(m_otherOptions); \
+		return new name ## Learner(m_alphabetSize, otherOptions.size(), otherOptions.data()); \
+	} \
+private: \
+	int m_alphabetSize; \
+	std::vector<jint> m_otherOptions; \
 public: \
 	alfClass m_algorithm; \
 }; \
 static LearnerMetadataDecl g_metadata_ ## name(#name, &name ## Learner::init)
 
+#define DEFINE_LEARNER(name, type, alfClass, ...) \
+	DEFINE_LEARNER_CLASS(name, type, true, alfClass, ##__VA_ARGS__)
+#define DEFINE_PASSIVE_LEARNER(name, type, alfClass, ...) \
+	DEFINE_LEARNER_CLASS(name, type, false, alfClass, ##__VA_ARGS__)
+
 
 
 static bool kvUseBinarySearch(size_t otherOptsLen, jint *otherOptions)
@@ -87,11 +108,14 @@ DEFINE_LEARNER(ANGLUIN_COL_DFA, DFA, libalf::angluin_col_table<bool>);
 DEFINE_LEARNER(KV_DFA, DFA, libalf::kearns_vazirani<bool>, kvUseBinarySearch(otherOptsLen, otherOptions));
 DEFINE_LEARNER(RS_DFA, DFA, libalf::rivest_schapire_table<bool>);
 DEFINE_LEARNER(NLSTAR, NFA, libalf::NLstar_table<bool>);
+DEFINE_LEARNER(ANGLUIN_SIMPLE_MEALY, Mealy, libalf::angluin_simple_table<int>);
+DEFINE_LEARNER(ANGLUIN_COL_MEALY, Mealy, libalf::angluin_col_table<int>);
+DEFINE_LEARNER(RS_MEALY, Mealy, libalf::rivest_schapire_table<int>);
 
-DEFINE_LEARNER(RPNI, DFA, libalf::RPNI<bool>);
-DEFINE_LEARNER(DELETE2, NFA, libalf::DeLeTe2<bool>);
-DEFINE_LEARNER(BIERMANN_MINISAT, DFA, libalf::MiniSat_biermann<bool>);
-DEFINE_LEARNER(BIERMANN_ORIGINAL_DFA, DFA, libalf::original_biermann<bool>, 1);
+DEFINE_PASSIVE_LEARNER(RPNI, DFA, libalf::RPNI<bool>);
+DEFINE_PASSIVE_LEARNER(DELETE2, NFA, libalf::DeLeTe2<bool>);
+DEFINE_PASSIVE_LEARNER(BIERMANN_MINISAT, DFA, libalf::MiniSat_biermann<bool>);
+DEFINE_PASSIVE_LEARNER(BIERMANN_ORIGINAL_DFA, DFA, libalf::original_biermann<bool>, 1);
 
 class LibalfInstanceMgr {
 public:
@@ -111,6 +135,19 @@ public:
 		return instance;
 	}
 
+	LibAlf *createRemote(JNIEnv *env, jobjectArray algIds, const char *socketPath)
+	{
+		LibAlf *instance = new LibAlf(env, algIds);
+		if (!instance->connectRemote(socketPath)) {
+			delete instance;
+			return NULL;
+		}
+		m_instances.push_front(instance);
+		instance->m_ref = m_instances.begin();
+
+		return instance;
+	}
+
 	void dispose(LibAlf *instance)
 	{
 		m_instances.erase(instance->m_ref);
@@ -125,20 +162,45 @@ static LibalfInstanceMgr g_instanceMgr;
 
 
 LibAlf::LibAlf(JNIEnv *env, jobjectArray algIds)
+	: m_remoteId(0)
 {
 	jclass objClazz = env->FindClass("java/lang/Object");
 	jmethodID toStringMethod = env->GetMethodID(objClazz, "toString", "()Ljava/lang/String;");
 
 	jint numAlgs = env->GetArrayLength(algIds);
-	m_inits.reserve(static_cast<size_t>(numAlgs));
+	m_algNames.reserve(static_cast<size_t>(numAlgs));
 
 	for (jint i = 0; i < numAlgs; i++) {
 		jobject alg = env->GetObjectArrayElement(algIds, i);
 		jstring jname = static_cast<jstring>(env->CallObjectMethod(alg, toStringMethod));
 		env->DeleteLocalRef(alg);
 		const char *name = env->GetStringUTFChars(jname, NULL);
-		std::map<const char *, LearnerInit *>::iterator initIt = g_learnerInits.find(name);
+		m_algNames.push_back(name);
 		env->ReleaseStringUTFChars(jname, name);
+	}
+
+	initAlgorithms();
+}
+
+LibAlf::LibAlf(const std::vector<std::string> &algNames)
+	: m_algNames(algNames), m_remoteId(0)
+{
+	initAlgorithms();
+}
+
+LibAlf::~LibAlf(void)
+{
+	if (m_remote) {
+		m_remote->disposeSession(m_remoteId);
+	}
+}
+
+void LibAlf::initAlgorithms(void)
+{
+	m_inits.reserve(m_algNames.size());
+
+	for (std::vector<std::string>::const_iterator it = m_algNames.begin(); it != m_algNames.end(); ++it) {
+		std::map<const char *, LearnerInit *>::iterator initIt = g_learnerInits.find(it->c_str());
 		LearnerInit *init = NULL;
 		if (initIt != g_learnerInits.end()) {
 			init = initIt->second;
@@ -147,6 +209,21 @@ LibAlf::LibAlf(JNIEnv *env, jobjectArray algIds)
 	}
 }
 
+bool LibAlf::connectRemote(const char *socketPath)
+{
+	std::shared_ptr<RemoteConnection> remote = RemoteConnection::connect(socketPath);
+	if (!remote) {
+		return false;
+	}
+	uint64_t remoteId = remote->createSession(m_algNames);
+	if (!remoteId) {
+		return false;
+	}
+	m_remote = remote;
+	m_remoteId = remoteId;
+	return true;
+}
+
 LibalfLearner *LibAlf::createLearner(jint algorithmId, jint alphabetSize, size_t otherOptsLen, jint *otherOpts) const
 {
 	if (algorithmId < 0 || static_cast<size_t>(algorithmId) >= m_inits.size()) {
@@ -156,6 +233,9 @@ LibalfLearner *LibAlf::createLearner(jint algorithmId, jint alphabetSize, size_t
 	if (!init) {
 		return NULL;
 	}
+	if (m_remote) {
+		return m_remote->createLearner(m_remote, m_remoteId, algorithmId, alphabetSize, otherOptsLen, otherOpts);
+	}
 	return (*init)(alphabetSize, otherOptsLen, otherOpts);
 }
 
@@ -175,6 +255,21 @@ JNIEXPORT jbyteArray JNICALL Java_de_learnlib_libalf_LibAlf_init
 	return JNIUtil::createPtr(env, instance);
 }
 
+/*
+ * Class:     de_learnlib_libalf_LibAlf
+ * Method:    initRemote
+ * Signature: (Ljava/lang/String;[Lde/learnlib/libalf/LibAlf/AlgorithmID;)[B
+ */
+JNIEXPORT jbyteArray JNICALL Java_de_learnlib_libalf_LibAlf_initRemote
+  (JNIEnv *env, jclass clazz, jstring jSocketPath, jobjectArray jAlgIds)
+{
+	const char *socketPath = env->GetStringUTFChars(jSocketPath, NULL);
+	LibAlf *instance = g_instanceMgr.createRemote(env, jAlgIds, socketPath);
+	env->ReleaseStringUTFChars(jSocketPath, socketPath);
+
+	return JNIUtil::createPtr(env, instance);
+}
+
 /*
  * Class:     de_learnlib_libalf_LibAlf
  * Method:    dispose
@@ -204,6 +299,10 @@ JNIEXPORT jbyteArray JNICALL Java_de_learnlib_libalf_LibAlf_initAlgorithm
 	}
 
 	LibalfLearner *alg = instance->createLearner(algorithmId, alphabetSize, otherOptsLen, otherOpts);
+	if (alg) {
+		alg->setRecorder(SessionLog::Recorder::create(instance->algorithmName(algorithmId),
+				alphabetSize, otherOptsLen, otherOpts));
+	}
 
 	if (otherOpts) {
 		env->ReleasePrimitiveArrayCritical(jOtherOpts, otherOpts, 0);
@@ -212,5 +311,37 @@ JNIEXPORT jbyteArray JNICALL Java_de_learnlib_libalf_LibAlf_initAlgorithm
 	return JNIUtil::createPtr(env, alg);
 }
 
-};
+/*
+ * Class:     de_learnlib_libalf_LibAlf
+ * Method:    setRecordingDirectory
+ * Signature: (Ljava/lang/String;)V
+ */
+JNIEXPORT void JNICALL Java_de_learnlib_libalf_LibAlf_setRecordingDirectory
+  (JNIEnv *env, jclass clazz, jstring jDir)
+{
+	if (!jDir) {
+		SessionLog::setRecordingDirectory(NULL);
+		return;
+	}
+	const char *dir = env->GetStringUTFChars(jDir, NULL);
+	SessionLog::setRecordingDirectory(dir);
+	env->ReleaseStringUTFChars(jDir, dir);
+}
+
+/*
+ * Class:     de_learnlib_libalf_LibAlf
+ * Method:    setEncodingParallelism
+ * Signature: (IJ)V
+ */
+JNIEXPORT void JNICALL Java_de_learnlib_libalf_LibAlf_setEncodingParallelism
+  (JNIEnv *env, jclass clazz, jint numThreads, jlong minBytes)
+{
+	if (numThreads >= 0) {
+		ThreadPool::configureShared(static_cast<unsigned>(numThreads));
+	}
+	if (minBytes >= 0) {
+		SAF::setParallelThreshold(static_cast<size_t>(minBytes));
+	}
+}
 
+};
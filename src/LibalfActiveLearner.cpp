@@ -19,8 +19,31 @@
 // JNI method implementations for the LibalfActiveLearner class
 // Author: Malte Isberner
 
+#include <vector>
+
 #include "LibalfLearner.hpp"
 #include "JNIUtil.hpp"
+#include "WordCodec.hpp"
+#include "PackedCodec.hpp"
+#include "MembershipOracle.hpp"
+
+/*
+ * Reports a learner that neither produced a conjecture nor posed queries as
+ * a byte array holding the single byte ADVANCE_STALLED. No SAF encoding is
+ * that short, and the empty array already stands for an expired budget.
+ */
+enum { ADVANCE_STALLED = 1 };
+
+static jbyteArray createStalledArray(JNIEnv *env)
+{
+	jbyteArray result = env->NewByteArray(1);
+	if (!result) {
+		return NULL;
+	}
+	jbyte status = ADVANCE_STALLED;
+	env->SetByteArrayRegion(result, 0, 1, &status);
+	return result;
+}
 
 extern "C" {
 
@@ -34,6 +57,9 @@ JNIEXPORT jbyteArray JNICALL Java_de_learnlib_libalf_LibalfActiveLearner_fetchQu
 {
 	LibalfLearner &learner = JNIUtil::extractRef<LibalfLearner>(env, ptr);
 	QueryBatch *queryBatch = learner.getQueries();
+	if (learner.recorder()) {
+		learner.recorder()->recordQueries(*queryBatch);
+	}
 	return JNIUtil::createPtr(env, queryBatch);
 }
 
@@ -46,30 +72,100 @@ JNIEXPORT jintArray JNICALL Java_de_learnlib_libalf_LibalfActiveLearner_getQueri
   (JNIEnv *env, jclass clazz, jbyteArray batchPtr)
 {
 	QueryBatch &queryBatch = JNIUtil::extractRef<QueryBatch>(env, batchPtr);
-	size_t numQueries = queryBatch.size();
-	size_t totalSpace = 1;
-	for (QueryBatch::iterator it = queryBatch.begin(); it != queryBatch.end(); ++it) {
-		totalSpace += it->size() + 1;
-	}
+	size_t totalSpace = WordCodec::encodedBatchSize(queryBatch);
 	jintArray result = env->NewIntArray(totalSpace);
 	if (!result) {
 		return NULL;
 	}
 	jint *queriesEnc = static_cast<jint *>(env->GetPrimitiveArrayCritical(result, NULL));
-	jint *p = queriesEnc;
-	*p++ = static_cast<jint>(numQueries);
-	for (QueryBatch::iterator it = queryBatch.begin(); it != queryBatch.end(); ++it) {
-		const Word &word = *it;
-		*p++ = static_cast<jint>(word.size());
-		for (Word::const_iterator it2 = word.begin(); it2 != word.end(); ++it2) {
-			*p++ = static_cast<jint>(*it2);
-		}
+	WordCodec::encodeBatch(queriesEnc, queryBatch);
+	env->ReleasePrimitiveArrayCritical(result, queriesEnc, 0);
+
+	return result;
+}
+
+/*
+ * Class:     de_learnlib_libalf_LibalfActiveLearner
+ * Method:    getQueriesPacked
+ * Signature: ([B[BI)[B
+ *
+ * Returns the batch in the packed encoding with the given lane width (see
+ * PackedCodec.hpp), or null if a symbol does not fit into a lane, or if the
+ * answers of the learner are not boolean, so they cannot be packed either.
+ */
+JNIEXPORT jbyteArray JNICALL Java_de_learnlib_libalf_LibalfActiveLearner_getQueriesPacked
+  (JNIEnv *env, jclass clazz, jbyteArray ptr, jbyteArray batchPtr, jint laneBytes)
+{
+	LibalfLearner &learner = JNIUtil::extractRef<LibalfLearner>(env, ptr);
+	QueryBatch &queryBatch = JNIUtil::extractRef<QueryBatch>(env, batchPtr);
+	size_t totalSize;
+	if (!learner.booleanAnswers() || !PackedCodec::validLaneBytes(laneBytes) || !PackedCodec::encodedBatchSize(queryBatch, laneBytes, totalSize)) {
+		return NULL;
+	}
+	jbyteArray result = env->NewByteArray(totalSize);
+	if (!result) {
+		return NULL;
 	}
+	unsigned char *queriesEnc = static_cast<unsigned char *>(env->GetPrimitiveArrayCritical(result, NULL));
+	PackedCodec::encodeBatch(queriesEnc, queryBatch, laneBytes);
 	env->ReleasePrimitiveArrayCritical(result, queriesEnc, 0);
 
 	return result;
 }
 
+/*
+ * Class:     de_learnlib_libalf_LibalfActiveLearner
+ * Method:    openQueryCursor
+ * Signature: ([B)[B
+ *
+ * The pages do not know their learner, so when recording, all pending
+ * queries are recorded here, as by fetchQueryBatch.
+ */
+JNIEXPORT jbyteArray JNICALL Java_de_learnlib_libalf_LibalfActiveLearner_openQueryCursor
+  (JNIEnv *env, jclass clazz, jbyteArray ptr)
+{
+	LibalfLearner &learner = JNIUtil::extractRef<LibalfLearner>(env, ptr);
+	if (learner.recorder()) {
+		QueryBatch *queryBatch = learner.getQueries();
+		learner.recorder()->recordQueries(*queryBatch);
+		delete queryBatch;
+	}
+	QueryCursor *cursor = learner.openQueryCursor();
+	return JNIUtil::createPtr(env, cursor);
+}
+
+/*
+ * Class:     de_learnlib_libalf_LibalfActiveLearner
+ * Method:    fetchQueryPage
+ * Signature: ([BII)[B
+ */
+JNIEXPORT jbyteArray JNICALL Java_de_learnlib_libalf_LibalfActiveLearner_fetchQueryPage
+  (JNIEnv *env, jclass clazz, jbyteArray cursorPtr, jint maxQueries, jint maxInts)
+{
+	QueryCursor &cursor = JNIUtil::extractRef<QueryCursor>(env, cursorPtr);
+	QueryBatch *page = new QueryBatch;
+	size_t maxQ = (maxQueries > 0) ? static_cast<size_t>(maxQueries) : 0;
+	size_t maxI = (maxInts > 0) ? static_cast<size_t>(maxInts) : 0;
+	if (!cursor.nextPage(*page, maxQ, maxI)) {
+		delete page;
+		return NULL;
+	}
+	// The page is encoded via getQueries, and released by processAnswers
+	return JNIUtil::createPtr(env, page);
+}
+
+/*
+ * Class:     de_learnlib_libalf_LibalfActiveLearner
+ * Method:    closeQueryCursor
+ * Signature: ([B)V
+ */
+JNIEXPORT void JNICALL Java_de_learnlib_libalf_LibalfActiveLearner_closeQueryCursor
+  (JNIEnv *env, jclass clazz, jbyteArray cursorPtr)
+{
+	QueryCursor *cursor = JNIUtil::extractPtr<QueryCursor>(env, cursorPtr);
+	delete cursor;
+}
+
 /*
  * Class:     de_learnlib_libalf_LibalfActiveLearner
  * Method:    processAnswers
@@ -83,18 +179,55 @@ JNIEXPORT void JNICALL Java_de_learnlib_libalf_LibalfActiveLearner_processAnswer
 	QueryBatch *queryBatch = JNIUtil::extractPtr<QueryBatch>(env, batchPtr);
 
 	jint *answers = static_cast<jint *>(env->GetPrimitiveArrayCritical(jAnswers, NULL));
-	jint *answp = answers;
 
-	for (QueryBatch::iterator it = queryBatch->begin(); it != queryBatch->end(); ++it) {
-		Word &word = *it;
-		learner.addEncodedAnswer(word, *answp++);
+	if (learner.recorder()) {
+		learner.recorder()->recordAnswers(*queryBatch, answers);
 	}
 
+	learner.addEncodedAnswers(*queryBatch, answers);
+
 	env->ReleasePrimitiveArrayCritical(jAnswers, answers, 0);
 
 	delete queryBatch;
 }
 
+/*
+ * Class:     de_learnlib_libalf_LibalfActiveLearner
+ * Method:    processAnswersPacked
+ * Signature: ([B[B[B)Z
+ *
+ * Like processAnswers, with the boolean answers packed into a bitmap.
+ * Returns false if the learner does not take boolean answers or the bitmap
+ * is too short; the batch is then not released, and can be answered via
+ * processAnswers instead.
+ */
+JNIEXPORT jboolean JNICALL Java_de_learnlib_libalf_LibalfActiveLearner_processAnswersPacked
+  (JNIEnv *env, jclass clazz, jbyteArray ptr, jbyteArray batchPtr, jbyteArray jBitmap)
+{
+	LibalfLearner &learner = JNIUtil::extractRef<LibalfLearner>(env, ptr);
+
+	QueryBatch *queryBatch = JNIUtil::extractPtr<QueryBatch>(env, batchPtr);
+
+	size_t numAnswers = queryBatch->size();
+	if (!learner.booleanAnswers() || static_cast<size_t>(env->GetArrayLength(jBitmap)) < PackedCodec::bitmapSize(numAnswers)) {
+		return JNI_FALSE;
+	}
+
+	std::vector<jint> answers(numAnswers);
+	unsigned char *bitmap = static_cast<unsigned char *>(env->GetPrimitiveArrayCritical(jBitmap, NULL));
+	PackedCodec::unpackAnswers(bitmap, numAnswers, answers.data());
+	env->ReleasePrimitiveArrayCritical(jBitmap, bitmap, JNI_ABORT);
+
+	if (learner.recorder()) {
+		learner.recorder()->recordAnswers(*queryBatch, answers.data());
+	}
+
+	learner.addEncodedAnswers(*queryBatch, answers.data());
+
+	delete queryBatch;
+	return JNI_TRUE;
+}
+
 /*
  * Class:     de_learnlib_libalf_LibalfActiveLearner
  * Method:    addCounterExample
@@ -107,16 +240,166 @@ JNIEXPORT void JNICALL Java_de_learnlib_libalf_LibalfActiveLearner_addCounterExa
 
 	jint wordLen = env->GetArrayLength(jWord);
 	jint *word = static_cast<jint *>(env->GetPrimitiveArrayCritical(jWord, NULL));
-	jint *wordp = word;
 
-	Word w;
-	while (wordLen--) {
-		w.push_back(*wordp++);
-	}
+	ScratchWord &scratch = learner.scratchWord();
+	scratch.assign(word, word + wordLen);
+	Word &w = scratch.word();
 
-	env->ReleasePrimitiveArrayCritical(jWord, word, 0);
+	env->ReleasePrimitiveArrayCritical(jWord, word, JNI_ABORT);
 
+	if (learner.recorder()) {
+		learner.recorder()->recordCounterExample(w);
+	}
 	learner.addCounterExample(w);
 }
 
+/*
+ * Class:     de_learnlib_libalf_LibalfActiveLearner
+ * Method:    setCounterExampleShortening
+ * Signature: ([BZ)Z
+ */
+JNIEXPORT jboolean JNICALL Java_de_learnlib_libalf_LibalfActiveLearner_setCounterExampleShortening
+  (JNIEnv *env, jclass clazz, jbyteArray ptr, jboolean enable)
+{
+	LibalfLearner &learner = JNIUtil::extractRef<LibalfLearner>(env, ptr);
+
+	if (learner.recorder()) {
+		learner.recorder()->recordCEShortening(enable);
+	}
+	return learner.setCounterExampleShortening(enable) ? JNI_TRUE : JNI_FALSE;
+}
+
+/*
+ * Class:     de_learnlib_libalf_LibalfActiveLearner
+ * Method:    getCounterExampleStats
+ * Signature: ([B)[J
+ */
+JNIEXPORT jlongArray JNICALL Java_de_learnlib_libalf_LibalfActiveLearner_getCounterExampleStats
+  (JNIEnv *env, jclass clazz, jbyteArray ptr)
+{
+	LibalfLearner &learner = JNIUtil::extractRef<LibalfLearner>(env, ptr);
+
+	const CEShortening::Stats *stats = learner.getCounterExampleStats();
+	if (!stats) {
+		return NULL;
+	}
+
+	jlong statsEnc[] = {
+		stats->counterExamples,
+		stats->shortened,
+		stats->symbolsIn,
+		stats->symbolsOut,
+		stats->knowledgeHits
+	};
+	jsize numStats = static_cast<jsize>(sizeof(statsEnc) / sizeof(statsEnc[0]));
+
+	jlongArray result = env->NewLongArray(numStats);
+	if (!result) {
+		return NULL;
+	}
+	env->SetLongArrayRegion(result, 0, numStats, statsEnc);
+
+	return result;
+}
+
+/*
+ * Class:     de_learnlib_libalf_LibalfActiveLearner
+ * Method:    fork
+ * Signature: ([B)[B
+ *
+ * The fork is not recorded; the log of the original learner notes the
+ * fork, as its queries may be answered by the fork from then on.
+ */
+JNIEXPORT jbyteArray JNICALL Java_de_learnlib_libalf_LibalfActiveLearner_fork
+  (JNIEnv *env, jclass clazz, jbyteArray ptr)
+{
+	LibalfLearner &learner = JNIUtil::extractRef<LibalfLearner>(env, ptr);
+	LibalfLearner *clone = learner.fork();
+	if (clone && learner.recorder()) {
+		learner.recorder()->recordFork();
+	}
+	return JNIUtil::createPtr(env, clone);
+}
+
+/*
+ * Class:     de_learnlib_libalf_LibalfActiveLearner
+ * Method:    getSharedAnswerStats
+ * Signature: ([B)[J
+ */
+JNIEXPORT jlongArray JNICALL Java_de_learnlib_libalf_LibalfActiveLearner_getSharedAnswerStats
+  (JNIEnv *env, jclass clazz, jbyteArray ptr)
+{
+	LibalfLearner &learner = JNIUtil::extractRef<LibalfLearner>(env, ptr);
+
+	const AnswerCache *cache = learner.answerCache();
+	if (!cache) {
+		return NULL;
+	}
+
+	jlong statsEnc[] = {
+		cache->size(),
+		cache->hits()
+	};
+	jsize numStats = static_cast<jsize>(sizeof(statsEnc) / sizeof(statsEnc[0]));
+
+	jlongArray result = env->NewLongArray(numStats);
+	if (!result) {
+		return NULL;
+	}
+	env->SetLongArrayRegion(result, 0, numStats, statsEnc);
+
+	return result;
+}
+
+/*
+ * Class:     de_learnlib_libalf_LibalfActiveLearner
+ * Method:    advanceWithOracle
+ * Signature: ([B[B)[B
+ *
+ * Returns the encoded conjecture, an empty array if the budget expired, a
+ * one-byte array (see createStalledArray) if the learner stalled without
+ * posing queries, or NULL if memory for the result could not be allocated.
+ */
+JNIEXPORT jbyteArray JNICALL Java_de_learnlib_libalf_LibalfActiveLearner_advanceWithOracle
+  (JNIEnv *env, jclass clazz, jbyteArray ptr, jbyteArray oraclePtr)
+{
+	LibalfLearner &learner = JNIUtil::extractRef<LibalfLearner>(env, ptr);
+	MembershipOracle &oracle = JNIUtil::extractRef<MembershipOracle>(env, oraclePtr);
+
+	for (;;) {
+		if (learner.budget().expired()) {
+			return createTimedOutArray(env, learner);
+		}
+		bool conjecture = learner.advance();
+		SessionLog::Recorder *recorder = learner.recorder();
+		if (recorder) {
+			recorder->recordAdvance(conjecture, conjecture ? learner.computeConjectureSize() : 0);
+		}
+		if (conjecture) {
+			return createConjectureArray(env, learner);
+		}
+		if (learner.budget().expired()) {
+			return createTimedOutArray(env, learner);
+		}
+		QueryBatch *queryBatch = learner.getQueries();
+		if (queryBatch->empty()) {
+			delete queryBatch;
+			return createStalledArray(env);
+		}
+		if (recorder) {
+			// the answers of the native oracle are recorded like answers
+			// from the Java side
+			recorder->recordQueries(*queryBatch);
+			std::vector<jint> answers(queryBatch->size());
+			oracle.answerQueries(*queryBatch, answers.data());
+			recorder->recordAnswers(*queryBatch, answers.data());
+			learner.addEncodedAnswers(*queryBatch, answers.data());
+		}
+		else {
+			oracle.processQueries(learner, *queryBatch);
+		}
+		delete queryBatch;
+	}
+}
+
 };
@@ -22,11 +22,40 @@
 #include "LibalfLearner.hpp"
 #include "LibAlf.hpp"
 #include "JNIUtil.hpp"
+#include "WordCodec.hpp"
 
 #include <libalf/alf.h>
 #include <libalf/learning_algorithm.h>
 
 
+jbyteArray createTimedOutArray(JNIEnv *env, LibalfLearner &learner)
+{
+	learner.budget().acknowledge();
+	return env->NewByteArray(0);
+}
+
+jbyteArray createConjectureArray(JNIEnv *env, LibalfLearner &learner)
+{
+	size_t cjLen = learner.computeConjectureSize();
+	jbyteArray result = env->NewByteArray(cjLen);
+	if (!result) {
+		return NULL;
+	}
+	jbyte *cjEnc = static_cast<jbyte *>(env->GetPrimitiveArrayCritical(result, NULL));
+	bool complete = learner.encodeConjecture(cjEnc, cjLen);
+	env->ReleasePrimitiveArrayCritical(result, cjEnc, complete ? 0 : JNI_ABORT);
+	if (!complete) {
+		env->DeleteLocalRef(result);
+		return createTimedOutArray(env, learner);
+	}
+
+	return result;
+}
+
+static jint clampToInt(jlong value)
+{
+	return (value > 0x7fffffff) ? 0x7fffffff : static_cast<jint>(value);
+}
 
 // JNI native methods
 
@@ -41,24 +70,148 @@ JNIEXPORT jbyteArray JNICALL Java_de_learnlib_libalf_LibalfLearner_advance
   (JNIEnv *env, jclass clazz, jbyteArray jptr)
 {
 	LibalfLearner &learner = JNIUtil::extractRef<LibalfLearner>(env, jptr);
-	const libalf::conjecture *cj = learner.advance();
-	if (!cj) {
+	if (learner.budget().expired()) {
+		return createTimedOutArray(env, learner);
+	}
+	bool conjecture = learner.advance();
+	if (learner.recorder()) {
+		learner.recorder()->recordAdvance(conjecture, conjecture ? learner.computeConjectureSize() : 0);
+	}
+	if (!conjecture) {
+		return learner.budget().expired() ? createTimedOutArray(env, learner) : NULL;
+	}
+	return createConjectureArray(env, learner);
+}
+
+/*
+ * Class:     de_learnlib_libalf_LibalfLearner
+ * Method:    getConjecture
+ * Signature: ([B)[B
+ *
+ * Encodes the current conjecture again, e.g. after its encoding by advance
+ * was interrupted by the budget. Returns NULL if no conjecture has been
+ * derived yet.
+ */
+JNIEXPORT jbyteArray JNICALL Java_de_learnlib_libalf_LibalfLearner_getConjecture
+  (JNIEnv *env, jclass clazz, jbyteArray jptr)
+{
+	LibalfLearner &learner = JNIUtil::extractRef<LibalfLearner>(env, jptr);
+	if (!learner.hasConjecture()) {
 		return NULL;
 	}
-	size_t cjLen = learner.computeConjectureSize(*cj);
-	jbyteArray result = env->NewByteArray(cjLen);
+	return createConjectureArray(env, learner);
+}
+
+/*
+ * Class:     de_learnlib_libalf_LibalfLearner
+ * Method:    advanceHandle
+ * Signature: ([B)[B
+ *
+ * Like advance, but returns a handle to the conjecture instead of its
+ * encoding, which must be released via releaseConjecture.
+ */
+JNIEXPORT jbyteArray JNICALL Java_de_learnlib_libalf_LibalfLearner_advanceHandle
+  (JNIEnv *env, jclass clazz, jbyteArray jptr)
+{
+	LibalfLearner &learner = JNIUtil::extractRef<LibalfLearner>(env, jptr);
+	if (learner.budget().expired()) {
+		return createTimedOutArray(env, learner);
+	}
+	bool conjecture = learner.advance();
+	if (learner.recorder()) {
+		learner.recorder()->recordAdvance(conjecture, conjecture ? learner.computeConjectureSize() : 0);
+	}
+	if (!conjecture) {
+		return learner.budget().expired() ? createTimedOutArray(env, learner) : NULL;
+	}
+	ConjectureHandle *handle = learner.openConjecture();
+	if (!handle) {
+		return createTimedOutArray(env, learner);
+	}
+	return JNIUtil::createPtr(env, handle);
+}
+
+/*
+ * Class:     de_learnlib_libalf_LibalfLearner
+ * Method:    getConjectureInfo
+ * Signature: ([B)[J
+ *
+ * The result holds the native format (see ConjectureHandle::Format), the
+ * number of states, the alphabet size, the number of transitions (-1 if
+ * unknown) and the size of the complete encoding in the native format.
+ */
+JNIEXPORT jlongArray JNICALL Java_de_learnlib_libalf_LibalfLearner_getConjectureInfo
+  (JNIEnv *env, jclass clazz, jbyteArray handlePtr)
+{
+	ConjectureHandle &handle = JNIUtil::extractRef<ConjectureHandle>(env, handlePtr);
+
+	size_t encodedSize = 0;
+	handle.computePartSize(ConjectureHandle::NATIVE_FORMAT, 0, handle.numStates(), encodedSize);
+
+	jlong infoEnc[] = {
+		handle.nativeFormat(),
+		handle.numStates(),
+		handle.alphabetSize(),
+		handle.numTransitions(),
+		static_cast<jlong>(encodedSize)
+	};
+	jsize numInfos = static_cast<jsize>(sizeof(infoEnc) / sizeof(infoEnc[0]));
+
+	jlongArray result = env->NewLongArray(numInfos);
 	if (!result) {
-		delete cj;
 		return NULL;
 	}
-	jbyte *cjEnc = static_cast<jbyte *>(env->GetPrimitiveArrayCritical(result, NULL));
-	learner.encodeConjecture(cjEnc, cjLen, *cj);
-	env->ReleasePrimitiveArrayCritical(result, cjEnc, 0);
-	delete cj;
+	env->SetLongArrayRegion(result, 0, numInfos, infoEnc);
 
 	return result;
 }
 
+/*
+ * Class:     de_learnlib_libalf_LibalfLearner
+ * Method:    encodeConjecturePart
+ * Signature: ([BIII)[B
+ *
+ * Encodes the part of the conjecture for the states [begin, end) in the
+ * given format (see SAF.hpp), or returns NULL if the format or range is not
+ * supported.
+ */
+JNIEXPORT jbyteArray JNICALL Java_de_learnlib_libalf_LibalfLearner_encodeConjecturePart
+  (JNIEnv *env, jclass clazz, jbyteArray handlePtr, jint format, jint begin, jint end)
+{
+	ConjectureHandle &handle = JNIUtil::extractRef<ConjectureHandle>(env, handlePtr);
+	ConjectureHandle::Format fmt = static_cast<ConjectureHandle::Format>(format);
+
+	size_t size;
+	if (!handle.computePartSize(fmt, begin, end, size)) {
+		return NULL;
+	}
+	jbyteArray result = env->NewByteArray(size);
+	if (!result) {
+		return NULL;
+	}
+	jbyte *partEnc = static_cast<jbyte *>(env->GetPrimitiveArrayCritical(result, NULL));
+	bool complete = handle.encodePart(fmt, begin, end, partEnc, size);
+	env->ReleasePrimitiveArrayCritical(result, partEnc, complete ? 0 : JNI_ABORT);
+	if (!complete) {
+		env->DeleteLocalRef(result);
+		return NULL;
+	}
+
+	return result;
+}
+
+/*
+ * Class:     de_learnlib_libalf_LibalfLearner
+ * Method:    releaseConjecture
+ * Signature: ([B)V
+ */
+JNIEXPORT void JNICALL Java_de_learnlib_libalf_LibalfLearner_releaseConjecture
+  (JNIEnv *env, jclass clazz, jbyteArray handlePtr)
+{
+	ConjectureHandle *handle = JNIUtil::extractPtr<ConjectureHandle>(env, handlePtr);
+	delete handle;
+}
+
 /*
  * Class:     de_learnlib_libalf_LibalfLearner
  * Method:    dispose
@@ -71,4 +224,201 @@ JNIEXPORT void JNICALL Java_de_learnlib_libalf_LibalfLearner_dispose
 	delete learner;
 }
 
+/*
+ * Class:     de_learnlib_libalf_LibalfLearner
+ * Method:    setDeadline
+ * Signature: ([BJ)V
+ */
+JNIEXPORT void JNICALL Java_de_learnlib_libalf_LibalfLearner_setDeadline
+  (JNIEnv *env, jclass clazz, jbyteArray ptr, jlong millis)
+{
+	LibalfLearner &learner = JNIUtil::extractRef<LibalfLearner>(env, ptr);
+	if (learner.recorder()) {
+		learner.recorder()->recordDeadline(millis);
+	}
+	learner.budget().setDeadline(millis);
+}
+
+/*
+ * Class:     de_learnlib_libalf_LibalfLearner
+ * Method:    cancel
+ * Signature: ([B)V
+ */
+JNIEXPORT void JNICALL Java_de_learnlib_libalf_LibalfLearner_cancel
+  (JNIEnv *env, jclass clazz, jbyteArray ptr)
+{
+	LibalfLearner &learner = JNIUtil::extractRef<LibalfLearner>(env, ptr);
+	if (learner.recorder()) {
+		learner.recorder()->recordCancel();
+	}
+	learner.cancel();
+}
+
+/*
+ * Class:     de_learnlib_libalf_LibalfLearner
+ * Method:    getRecordingState
+ * Signature: ([B)I
+ *
+ * Returns 1 if the session of the learner is being recorded, 0 if it is
+ * not, and -1 if recording stopped because writing the log failed.
+ */
+JNIEXPORT jint JNICALL Java_de_learnlib_libalf_LibalfLearner_getRecordingState
+  (JNIEnv *env, jclass clazz, jbyteArray ptr)
+{
+	LibalfLearner &learner = JNIUtil::extractRef<LibalfLearner>(env, ptr);
+	SessionLog::Recorder *recorder = learner.recorder();
+	if (!recorder) {
+		return 0;
+	}
+	return recorder->failed() ? -1 : 1;
+}
+
+/*
+ * Class:     de_learnlib_libalf_LibalfLearner
+ * Method:    diffHypotheses
+ * Signature: ([BI)[I
+ *
+ * The result holds the number of discovered product states and the number
+ * of distinguishing product states (both saturated at Integer.MAX_VALUE),
+ * followed by the encoded batch of distinguishing words. An empty array is
+ * returned if the budget expired, and NULL if there is no previous
+ * hypothesis to compare to.
+ */
+JNIEXPORT jintArray JNICALL Java_de_learnlib_libalf_LibalfLearner_diffHypotheses
+  (JNIEnv *env, jclass clazz, jbyteArray ptr, jint maxWords)
+{
+	LibalfLearner &learner = JNIUtil::extractRef<LibalfLearner>(env, ptr);
+
+	QueryBatch words;
+	HypothesisDiff::Stats stats;
+	switch (learner.diffHypotheses((maxWords > 0) ? static_cast<size_t>(maxWords) : 0, words, stats)) {
+	case HypothesisDiff::OK:
+		break;
+	case HypothesisDiff::TIMED_OUT:
+		learner.budget().acknowledge();
+		return env->NewIntArray(0);
+	default:
+		return NULL;
+	}
+
+	size_t totalSpace = 2 + WordCodec::encodedBatchSize(words);
+	jintArray result = env->NewIntArray(totalSpace);
+	if (!result) {
+		return NULL;
+	}
+	jint *resultEnc = static_cast<jint *>(env->GetPrimitiveArrayCritical(result, NULL));
+	resultEnc[0] = clampToInt(stats.productStates);
+	resultEnc[1] = clampToInt(stats.distinguishingStates);
+	WordCodec::encodeBatch(resultEnc + 2, words);
+	env->ReleasePrimitiveArrayCritical(result, resultEnc, 0);
+
+	return result;
+}
+
+/*
+ * Class:     de_learnlib_libalf_LibalfLearner
+ * Method:    enableSpill
+ * Signature: ([BLjava/lang/String;J)Z
+ */
+JNIEXPORT jboolean JNICALL Java_de_learnlib_libalf_LibalfLearner_enableSpill
+  (JNIEnv *env, jclass clazz, jbyteArray ptr, jstring jPath, jlong maxHotAnswers)
+{
+	LibalfLearner &learner = JNIUtil::extractRef<LibalfLearner>(env, ptr);
+
+	const char *path = env->GetStringUTFChars(jPath, NULL);
+	bool enabled = learner.enableSpill(path, maxHotAnswers);
+	env->ReleaseStringUTFChars(jPath, path);
+	if (enabled && learner.recorder()) {
+		learner.recorder()->recordSpill(maxHotAnswers);
+	}
+
+	return enabled ? JNI_TRUE : JNI_FALSE;
+}
+
+/*
+ * Class:     de_learnlib_libalf_LibalfLearner
+ * Method:    getSpillStats
+ * Signature: ([B)[J
+ */
+JNIEXPORT jlongArray JNICALL Java_de_learnlib_libalf_LibalfLearner_getSpillStats
+  (JNIEnv *env, jclass clazz, jbyteArray ptr)
+{
+	LibalfLearner &learner = JNIUtil::extractRef<LibalfLearner>(env, ptr);
+
+	const ColdAnswerStore *store = learner.coldAnswers();
+	if (!store) {
+		return NULL;
+	}
+
+	ColdAnswerStore::Stats stats = store->stats();
+	jlong statsEnc[] = {
+		stats.spills,
+		store->size(),
+		store->fileBytes(),
+		stats.lookups,
+		stats.hits
+	};
+	jsize numStats = static_cast<jsize>(sizeof(statsEnc) / sizeof(statsEnc[0]));
+
+	jlongArray result = env->NewLongArray(numStats);
+	if (!result) {
+		return NULL;
+	}
+	env->SetLongArrayRegion(result, 0, numStats, statsEnc);
+
+	return result;
+}
+
+/*
+ * Class:     de_learnlib_libalf_LibalfLearner
+ * Method:    setPostProcessing
+ * Signature: ([BZZ)Z
+ */
+JNIEXPORT jboolean JNICALL Java_de_learnlib_libalf_LibalfLearner_setPostProcessing
+  (JNIEnv *env, jclass clazz, jbyteArray ptr, jboolean minimize, jboolean verify)
+{
+	LibalfLearner &learner = JNIUtil::extractRef<LibalfLearner>(env, ptr);
+
+	if (learner.recorder()) {
+		learner.recorder()->recordPostProcessing(minimize, verify);
+	}
+	return learner.setPostProcessing(minimize, verify) ? JNI_TRUE : JNI_FALSE;
+}
+
+/*
+ * Class:     de_learnlib_libalf_LibalfLearner
+ * Method:    getPostProcessStats
+ * Signature: ([B)[J
+ */
+JNIEXPORT jlongArray JNICALL Java_de_learnlib_libalf_LibalfLearner_getPostProcessStats
+  (JNIEnv *env, jclass clazz, jbyteArray ptr)
+{
+	LibalfLearner &learner = JNIUtil::extractRef<LibalfLearner>(env, ptr);
+
+	const Minimization::Stats *stats = learner.getPostProcessStats();
+	if (!stats) {
+		return NULL;
+	}
+
+	jlong statsEnc[] = {
+		stats->conjectures,
+		stats->minimized,
+		stats->statesIn,
+		stats->statesOut,
+		stats->minimizeNanos,
+		stats->checkedAnswers,
+		stats->inconsistencies,
+		stats->checkNanos
+	};
+	jsize numStats = static_cast<jsize>(sizeof(statsEnc) / sizeof(statsEnc[0]));
+
+	jlongArray result = env->NewLongArray(numStats);
+	if (!result) {
+		return NULL;
+	}
+	env->SetLongArrayRegion(result, 0, numStats, statsEnc);
+
+	return result;
+}
+
 };
@@ -19,8 +19,12 @@
 // JNI method implementations for the LibalfPassiveLearner class
 // Author: Malte Isberner
 
+#include <vector>
+
 #include "LibalfLearner.hpp"
 #include "JNIUtil.hpp"
+#include "PackedCodec.hpp"
+#include "WordCodec.hpp"
 
 #include <jni.h>
 
@@ -30,31 +34,36 @@ extern "C" {
  * Class:     de_learnlib_libalf_LibalfPassiveLearner
  * Method:    addSamples
  * Signature: ([BI[I[I)Z
+ *
+ * Adds the samples in order, and stops at the first one that is malformed
+ * or conflicts with the samples added before. Only the added samples are
+ * recorded.
  */
 JNIEXPORT jboolean JNICALL Java_de_learnlib_libalf_LibalfPassiveLearner_addSamples
   (JNIEnv *env, jclass clazz, jbyteArray ptr, jint numSamples, jintArray jSamplesEnc, jintArray jOutputsEnc)
 {
 	LibalfLearner &learner = JNIUtil::extractRef<LibalfLearner>(env, ptr);
 
-	jint *samplesEnc = static_cast<jint *>(env->GetPrimitiveArrayCritical(jSamplesEnc, NULL));
-	jint *p = samplesEnc;
+	if (numSamples < 0 || env->GetArrayLength(jOutputsEnc) < numSamples) {
+		return JNI_FALSE;
+	}
+	size_t encLen = static_cast<size_t>(env->GetArrayLength(jSamplesEnc));
 
+	jint *samplesEnc = static_cast<jint *>(env->GetPrimitiveArrayCritical(jSamplesEnc, NULL));
 	jint *outputsEnc = static_cast<jint *>(env->GetPrimitiveArrayCritical(jOutputsEnc, NULL));
-	jint *q = outputsEnc;
 
-	jboolean ok = JNI_TRUE;
+	size_t added = learner.addEncodedSamples(static_cast<size_t>(numSamples), samplesEnc, samplesEnc + encLen, outputsEnc);
 
-	while (numSamples--) {
-		jint sampleLen = *p++;
-		Word sample;
-		while (sampleLen--) {
-			sample.push_back(static_cast<int>(*p++));
-		}
-		if (!learner.addEncodedAnswer(sample, *q++)) {
-			ok = JNI_FALSE;
-			break;
+	if (learner.recorder() && added) {
+		QueryBatch recorded;
+		const jint *p = samplesEnc;
+		for (size_t i = 0; i < added; i++) {
+			recorded.push_back(Word());
+			p = WordCodec::decodeWord(p, samplesEnc + encLen, recorded.back());
 		}
+		learner.recorder()->recordSamples(recorded, outputsEnc);
 	}
+	jboolean ok = (added == static_cast<size_t>(numSamples)) ? JNI_TRUE : JNI_FALSE;
 
 	env->ReleasePrimitiveArrayCritical(jOutputsEnc, outputsEnc, 0);
 	env->ReleasePrimitiveArrayCritical(jSamplesEnc, samplesEnc, 0);
@@ -62,4 +71,56 @@ JNIEXPORT jboolean JNICALL Java_de_learnlib_libalf_LibalfPassiveLearner_addSampl
 	return ok;
 }
 
+/*
+ * Class:     de_learnlib_libalf_LibalfPassiveLearner
+ * Method:    addSamplesPacked
+ * Signature: ([B[BI[B)Z
+ *
+ * Like addSamples, with the samples as a packed batch with the given lane
+ * width, and the boolean outputs packed into a bitmap (see PackedCodec.hpp).
+ * A batch whose bitmap is too short is rejected as a whole, as is any batch
+ * for a learner whose outputs are not boolean.
+ */
+JNIEXPORT jboolean JNICALL Java_de_learnlib_libalf_LibalfPassiveLearner_addSamplesPacked
+  (JNIEnv *env, jclass clazz, jbyteArray ptr, jbyteArray jSamplesEnc, jint laneBytes, jbyteArray jBitmap)
+{
+	LibalfLearner &learner = JNIUtil::extractRef<LibalfLearner>(env, ptr);
+
+	if (!learner.booleanAnswers() || !PackedCodec::validLaneBytes(laneBytes)) {
+		return JNI_FALSE;
+	}
+
+	size_t encLen = static_cast<size_t>(env->GetArrayLength(jSamplesEnc));
+	size_t bitmapLen = static_cast<size_t>(env->GetArrayLength(jBitmap));
+
+	const unsigned char *samplesEnc = static_cast<const unsigned char *>(env->GetPrimitiveArrayCritical(jSamplesEnc, NULL));
+	const unsigned char *end = samplesEnc + encLen;
+	size_t numSamples = 0;
+	const unsigned char *p = PackedCodec::decodeBatchSize(samplesEnc, end, numSamples);
+	// Every sample takes at least one byte, which also bounds the bitmap size
+	if (!p || static_cast<size_t>(end - p) < numSamples || bitmapLen < PackedCodec::bitmapSize(numSamples)) {
+		env->ReleasePrimitiveArrayCritical(jSamplesEnc, const_cast<unsigned char *>(samplesEnc), JNI_ABORT);
+		return JNI_FALSE;
+	}
+	const unsigned char *bitmap = static_cast<const unsigned char *>(env->GetPrimitiveArrayCritical(jBitmap, NULL));
+
+	size_t added = learner.addPackedSamples(numSamples, p, end, laneBytes, bitmap);
+
+	if (learner.recorder() && added) {
+		QueryBatch recorded;
+		std::vector<jint> outputs(added);
+		for (size_t i = 0; i < added; i++) {
+			recorded.push_back(Word());
+			p = PackedCodec::decodeWord(p, end, laneBytes, recorded.back());
+		}
+		PackedCodec::unpackAnswers(bitmap, added, outputs.data());
+		learner.recorder()->recordSamples(recorded, outputs.data());
+	}
+
+	env->ReleasePrimitiveArrayCritical(jBitmap, const_cast<unsigned char *>(bitmap), JNI_ABORT);
+	env->ReleasePrimitiveArrayCritical(jSamplesEnc, const_cast<unsigned char *>(samplesEnc), JNI_ABORT);
+
+	return (added == numSamples) ? JNI_TRUE : JNI_FALSE;
+}
+
 };
@@ -0,0 +1,491 @@
+/* Copyright (C) 2015 TU Dortmund
+ * This file is part of LearnLib, http://www.learnlib.de/.
+ * 
+ * LearnLib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 3.0 as published by the Free Software Foundation.
+ * 
+ * LearnLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with LearnLib; if not, see
+ * <http://www.gnu.de/documents/lgpl.en.html>.
+ */
+
+// Minimization.cpp
+// Implementation of conjecture post-processing
+
+#include <map>
+#include <list>
+#include <deque>
+#include <vector>
+#include <algorithm>
+
+#include "Minimization.hpp"
+
+namespace Minimization {
+
+// Number of states processed between two budget checks
+static const size_t BUDGET_CHECK_INTERVAL = 1024;
+
+namespace {
+
+/*
+ * Partition of the states into blocks, stored as a permutation of the
+ * states in which every block occupies a contiguous range. Marking a state
+ * moves it to the front of its block.
+ */
+class Partition {
+public:
+	Partition(int numStates)
+		: m_elems(numStates), m_loc(numStates), m_blockOf(numStates, 0)
+	{
+		for (int q = 0; q < numStates; q++) {
+			m_elems[q] = q;
+			m_loc[q] = q;
+		}
+		m_first.push_back(0);
+		m_end.push_back(numStates);
+		m_mid.push_back(0);
+	}
+
+	int numBlocks(void) const { return static_cast<int>(m_first.size()); }
+	int blockOf(int q) const { return m_blockOf[q]; }
+	const int *begin(int b) const { return &m_elems[0] + m_first[b]; }
+	const int *end(int b) const { return &m_elems[0] + m_end[b]; }
+
+	void mark(int q)
+	{
+		int b = m_blockOf[q];
+		int pos = m_loc[q];
+		if (pos < m_mid[b]) {
+			return;
+		}
+		int other = m_elems[m_mid[b]];
+		std::swap(m_elems[pos], m_elems[m_mid[b]]);
+		m_loc[other] = pos;
+		m_loc[q] = m_mid[b];
+		if (m_mid[b]++ == m_first[b]) {
+			m_touched.push_back(b);
+		}
+	}
+
+	/*
+	 * Splits every block with marked states into its marked and unmarked
+	 * part, storing the smaller part as a new block. Returns the new blocks.
+	 */
+	const std::vector<int> &split(void)
+	{
+		m_split.clear();
+		for (std::vector<int>::const_iterator it = m_touched.begin(); it != m_touched.end(); ++it) {
+			int b = *it;
+			int first = m_first[b], mid = m_mid[b], end = m_end[b];
+			m_mid[b] = first;
+			if (mid == end) {
+				continue;
+			}
+			int nb = numBlocks();
+			if (mid - first <= end - mid) {
+				m_first.push_back(first);
+				m_end.push_back(mid);
+				m_first[b] = mid;
+			}
+			else {
+				m_first.push_back(mid);
+				m_end.push_back(end);
+				m_end[b] = mid;
+			}
+			m_mid.push_back(m_first[nb]);
+			m_mid[b] = m_first[b];
+			for (int i = m_first[nb]; i < m_end[nb]; i++) {
+				m_blockOf[m_elems[i]] = nb;
+			}
+			m_split.push_back(nb);
+		}
+		m_touched.clear();
+		return m_split;
+	}
+
+private:
+	std::vector<int> m_elems;
+	std::vector<int> m_loc;
+	std::vector<int> m_blockOf;
+	std::vector<int> m_first;
+	std::vector<int> m_end;
+	std::vector<int> m_mid;
+	std::vector<int> m_touched;
+	std::vector<int> m_split;
+};
+
+}
+
+/*
+ * Predecessors per symbol and state, in CSR form, of the transition table
+ * completed with the given sink (if non-negative): the predecessors of state
+ * q on symbol a are states[offsets[a*total + q] .. offsets[a*total + q + 1]).
+ */
+struct Predecessors {
+	std::vector<int32_t> offsets;
+	std::vector<int32_t> states;
+};
+
+static inline int completedSuccessor(const std::vector<int32_t> &table, int k, int sink, int q, int a)
+{
+	if (q == sink) {
+		return sink;
+	}
+	int t = table[static_cast<size_t>(q) * k + a];
+	return (t < 0) ? sink : t;
+}
+
+static void computePredecessors(const std::vector<int32_t> &table, int k, int sink, int total, Predecessors &preds)
+{
+	preds.offsets.assign(static_cast<size_t>(k) * total + 1, 0);
+	preds.states.resize(static_cast<size_t>(k) * total);
+	for (int q = 0; q < total; q++) {
+		for (int a = 0; a < k; a++) {
+			int t = completedSuccessor(table, k, sink, q, a);
+			preds.offsets[static_cast<size_t>(a) * total + t + 1]++;
+		}
+	}
+	for (size_t i = 1; i < preds.offsets.size(); i++) {
+		preds.offsets[i] += preds.offsets[i - 1];
+	}
+	std::vector<int32_t> fill(preds.offsets.begin(), preds.offsets.end() - 1);
+	for (int q = 0; q < total; q++) {
+		for (int a = 0; a < k; a++) {
+			int t = completedSuccessor(table, k, sink, q, a);
+			preds.states[fill[static_cast<size_t>(a) * total + t]++] = q;
+		}
+	}
+}
+
+/*
+ * Refines the initial partition until it is compatible with the transitions
+ * (Hopcroft's algorithm). All initial blocks but one are used as splitters.
+ * Returns false if the budget expired.
+ */
+static bool refine(Partition &partition, const Predecessors &preds, int total, int k, const Budget *budget)
+{
+	std::deque<std::pair<int, int> > worklist;
+	for (int b = 1; b < partition.numBlocks(); b++) {
+		for (int a = 0; a < k; a++) {
+			worklist.push_back(std::make_pair(b, a));
+		}
+	}
+
+	std::vector<int> splitter;
+	size_t steps = 0;
+	while (!worklist.empty()) {
+		if (budget && ++steps % BUDGET_CHECK_INTERVAL == 0 && budget->expired()) {
+			return false;
+		}
+		int b = worklist.front().first;
+		int a = worklist.front().second;
+		worklist.pop_front();
+
+		splitter.assign(partition.begin(b), partition.end(b));
+		for (std::vector<int>::const_iterator it = splitter.begin(); it != splitter.end(); ++it) {
+			size_t cell = static_cast<size_t>(a) * total + *it;
+			for (int32_t i = preds.offsets[cell]; i < preds.offsets[cell + 1]; i++) {
+				partition.mark(preds.states[i]);
+			}
+		}
+		// The new block is always the smaller part, so it is the one to add
+		// for every symbol, whether or not its parent is pending
+		const std::vector<int> &newBlocks = partition.split();
+		for (std::vector<int>::const_iterator it = newBlocks.begin(); it != newBlocks.end(); ++it) {
+			for (int c = 0; c < k; c++) {
+				worklist.push_back(std::make_pair(*it, c));
+			}
+		}
+	}
+	return true;
+}
+
+FlatAutomaton *minimizeDFA(const FlatAutomaton &dfa, bool partial, const Budget *budget)
+{
+	int k = dfa.alphabetSize();
+	int n = dfa.numStates();
+	if (dfa.initialStates().empty() || n == 0) {
+		return NULL;
+	}
+	const std::vector<int32_t> &table = dfa.table();
+
+	// Completes the automaton with a sink, if required
+	partial = partial || (std::find(table.begin(), table.end(), -1) != table.end());
+	int sink = partial ? n : -1;
+	int total = partial ? n + 1 : n;
+
+	Predecessors preds;
+	computePredecessors(table, k, sink, total, preds);
+
+	// Initial partition into rejecting and accepting states
+	Partition partition(total);
+	for (int q = 0; q < n; q++) {
+		if (dfa.isAccepting(q)) {
+			partition.mark(q);
+		}
+	}
+	partition.split();
+	if (!refine(partition, preds, total, k, budget)) {
+		return NULL;
+	}
+
+	// Builds the quotient over the blocks reachable from the initial state,
+	// numbered in breadth-first order
+	int sinkBlock = partial ? partition.blockOf(sink) : -1;
+	std::vector<int> blockIndex(partition.numBlocks(), -1);
+	std::vector<int> order;
+	int initBlock = partition.blockOf(dfa.initialStates().front());
+	if (initBlock == sinkBlock) {
+		// the empty language: a single rejecting state without transitions
+		std::vector<uint32_t> acceptance(1, 0);
+		std::vector<int32_t> minTable(k, -1);
+		return new FlatAutomaton(k, 1, 0, acceptance, minTable);
+	}
+	blockIndex[initBlock] = 0;
+	order.push_back(initBlock);
+	std::vector<int32_t> minTable;
+	for (size_t i = 0; i < order.size(); i++) {
+		int rep = *partition.begin(order[i]);
+		for (int a = 0; a < k; a++) {
+			int t = table[static_cast<size_t>(rep) * k + a];
+			int tb = (t < 0) ? sinkBlock : partition.blockOf(t);
+			if (tb == sinkBlock) {
+				minTable.push_back(-1);
+				continue;
+			}
+			if (blockIndex[tb] < 0) {
+				blockIndex[tb] = static_cast<int>(order.size());
+				order.push_back(tb);
+			}
+			minTable.push_back(blockIndex[tb]);
+		}
+	}
+
+	int numStates = static_cast<int>(order.size());
+	std::vector<uint32_t> acceptance((numStates - 1)/32 + 1, 0);
+	for (int i = 0; i < numStates; i++) {
+		if (dfa.isAccepting(*partition.begin(order[i]))) {
+			acceptance[i / 32] |= static_cast<uint32_t>(1) << (i % 32);
+		}
+	}
+	return new FlatAutomaton(k, numStates, 0, acceptance, minTable);
+}
+
+FlatMealyMachine *minimizeMealy(const FlatMealyMachine &mm, const Budget *budget)
+{
+	int k = mm.alphabetSize();
+	int n = mm.numStates();
+	if (n == 0) {
+		return NULL;
+	}
+	const std::vector<int32_t> &table = mm.table();
+	const std::vector<int32_t> &outputs = mm.outputs();
+
+	// Completes the machine with a sink, whose transitions are all undefined
+	bool partial = (std::find(table.begin(), table.end(), -1) != table.end());
+	int sink = partial ? n : -1;
+	int total = partial ? n + 1 : n;
+
+	Predecessors preds;
+	computePredecessors(table, k, sink, total, preds);
+
+	// Initial partition by the definedness and outputs of the states'
+	// transitions, kept apart since any int is a valid output
+	std::map<std::vector<int32_t>, std::vector<int> > classes;
+	for (int q = 0; q < total; q++) {
+		std::vector<int32_t> row(2 * k, 0);
+		if (q != sink) {
+			for (int a = 0; a < k; a++) {
+				size_t cell = static_cast<size_t>(q) * k + a;
+				if (table[cell] >= 0) {
+					row[2 * a] = 1;
+					row[2 * a + 1] = outputs[cell];
+				}
+			}
+		}
+		classes[row].push_back(q);
+	}
+	Partition partition(total);
+	std::map<std::vector<int32_t>, std::vector<int> >::const_iterator cit = classes.begin();
+	for (++cit; cit != classes.end(); ++cit) {
+		for (std::vector<int>::const_iterator it = cit->second.begin(); it != cit->second.end(); ++it) {
+			partition.mark(*it);
+		}
+		partition.split();
+	}
+	if (!refine(partition, preds, total, k, budget)) {
+		return NULL;
+	}
+
+	// Builds the quotient over the blocks reachable from the initial state,
+	// numbered in breadth-first order
+	int sinkBlock = partial ? partition.blockOf(sink) : -1;
+	std::vector<int> blockIndex(partition.numBlocks(), -1);
+	std::vector<int> order;
+	std::vector<int32_t> minTable;
+	std::vector<int32_t> minOutputs;
+	int initBlock = partition.blockOf(mm.initialState());
+	if (initBlock == sinkBlock) {
+		// no outputs at all: a single state without transitions
+		minTable.assign(k, -1);
+		minOutputs.assign(k, 0);
+		return new FlatMealyMachine(k, 1, 0, minTable, minOutputs);
+	}
+	blockIndex[initBlock] = 0;
+	order.push_back(initBlock);
+	for (size_t i = 0; i < order.size(); i++) {
+		if (order[i] == sinkBlock) {
+			// reached by transitions with an output, but without any itself
+			minTable.insert(minTable.end(), k, -1);
+			minOutputs.insert(minOutputs.end(), k, 0);
+			continue;
+		}
+		int rep = *partition.begin(order[i]);
+		for (int a = 0; a < k; a++) {
+			size_t cell = static_cast<size_t>(rep) * k + a;
+			int t = table[cell];
+			if (t < 0) {
+				minTable.push_back(-1);
+				minOutputs.push_back(0);
+				continue;
+			}
+			int tb = partition.blockOf(t);
+			if (blockIndex[tb] < 0) {
+				blockIndex[tb] = static_cast<int>(order.size());
+				order.push_back(tb);
+			}
+			minTable.push_back(blockIndex[tb]);
+			minOutputs.push_back(outputs[cell]);
+		}
+	}
+
+	return new FlatMealyMachine(k, static_cast<int>(order.size()), 0, minTable, minOutputs);
+}
+
+FlatAutomaton *determinize(const FlatAutomaton &nfa, size_t maxStates, const Budget *budget)
+{
+	typedef std::vector<int32_t> StateSet;
+
+	int k = nfa.alphabetSize();
+	const std::vector<int32_t> &offsets = nfa.offsets();
+	const std::vector<int32_t> &targets = nfa.targets();
+
+	std::map<StateSet, int> index;
+	std::vector<const StateSet *> subsets;
+	std::vector<int32_t> table;
+
+	StateSet init(nfa.initialStates());
+	std::sort(init.begin(), init.end());
+	init.erase(std::unique(init.begin(), init.end()), init.end());
+	if (init.empty()) {
+		return NULL;
+	}
+	subsets.push_back(&index.insert(std::make_pair(init, 0)).first->first);
+
+	StateSet succ;
+	for (size_t i = 0; i < subsets.size(); i++) {
+		if (budget && i % BUDGET_CHECK_INTERVAL == 0 && budget->expired()) {
+			return NULL;
+		}
+		for (int a = 0; a < k; a++) {
+			succ.clear();
+			const StateSet &current = *subsets[i];
+			for (StateSet::const_iterator it = current.begin(); it != current.end(); ++it) {
+				size_t cell = static_cast<size_t>(*it) * k + a;
+				succ.insert(succ.end(), targets.begin() + offsets[cell], targets.begin() + offsets[cell + 1]);
+			}
+			if (succ.empty()) {
+				table.push_back(-1);
+				continue;
+			}
+			std::sort(succ.begin(), succ.end());
+			succ.erase(std::unique(succ.begin(), succ.end()), succ.end());
+			std::pair<std::map<StateSet, int>::iterator, bool> ins =
+				index.insert(std::make_pair(succ, static_cast<int>(subsets.size())));
+			if (ins.second) {
+				if (subsets.size() >= maxStates) {
+					return NULL;
+				}
+				subsets.push_back(&ins.first->first);
+			}
+			table.push_back(ins.first->second);
+		}
+	}
+
+	int numStates = static_cast<int>(subsets.size());
+	std::vector<uint32_t> acceptance((numStates - 1)/32 + 1, 0);
+	for (int i = 0; i < numStates; i++) {
+		const StateSet &s = *subsets[i];
+		for (StateSet::const_iterator it = s.begin(); it != s.end(); ++it) {
+			if (nfa.isAccepting(*it)) {
+				acceptance[i / 32] |= static_cast<uint32_t>(1) << (i % 32);
+				break;
+			}
+		}
+	}
+	return new FlatAutomaton(k, numStates, 0, acceptance, table);
+}
+
+static bool accepts(const FlatAutomaton &fa, const std::list<int> &w)
+{
+	if (fa.isDeterministic()) {
+		if (fa.initialStates().empty()) {
+			return false;
+		}
+		int q = fa.initialStates().front();
+		for (std::list<int>::const_iterator it = w.begin(); it != w.end() && q >= 0; ++it) {
+			if (*it < 0 || *it >= fa.alphabetSize()) {
+				return false;
+			}
+			q = fa.successor(q, *it);
+		}
+		return q >= 0 && fa.isAccepting(q);
+	}
+
+	std::vector<int32_t> current(fa.initialStates()), next;
+	const std::vector<int32_t> &offsets = fa.offsets();
+	const std::vector<int32_t> &targets = fa.targets();
+	for (std::list<int>::const_iterator it = w.begin(); it != w.end() && !current.empty(); ++it) {
+		if (*it < 0 || *it >= fa.alphabetSize()) {
+			return false;
+		}
+		next.clear();
+		for (std::vector<int32_t>::const_iterator sit = current.begin(); sit != current.end(); ++sit) {
+			size_t cell = static_cast<size_t>(*sit) * fa.alphabetSize() + *it;
+			next.insert(next.end(), targets.begin() + offsets[cell], targets.begin() + offsets[cell + 1]);
+		}
+		std::sort(next.begin(), next.end());
+		next.erase(std::unique(next.begin(), next.end()), next.end());
+		current.swap(next);
+	}
+	for (std::vector<int32_t>::const_iterator sit = current.begin(); sit != current.end(); ++sit) {
+		if (fa.isAccepting(*sit)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+size_t checkConsistency(const FlatAutomaton &fa, libalf::knowledgebase<bool> &kb, size_t &checkedAnswers)
+{
+	size_t inconsistencies = 0;
+	checkedAnswers = 0;
+	for (libalf::knowledgebase<bool>::iterator it = kb.begin(); it != kb.end(); ++it) {
+		if (!it->is_answered()) {
+			continue;
+		}
+		checkedAnswers++;
+		if (accepts(fa, it->get_word()) != it->get_answer()) {
+			inconsistencies++;
+		}
+	}
+	return inconsistencies;
+}
+
+};
@@ -0,0 +1,462 @@
+/* Copyright (C) 2015 TU Dortmund
+ * This file is part of LearnLib, http://www.learnlib.de/.
+ * 
+ * LearnLib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 3.0 as published by the Free Software Foundation.
+ * 
+ * LearnLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with LearnLib; if not, see
+ * <http://www.gnu.de/documents/lgpl.en.html>.
+ */
+
+// RemoteLearner.cpp
+// Implementation of the RemoteConnection and RemoteLearner classes
+
+#include <cstring>
+#include <algorithm>
+
+#include "RemoteLearner.hpp"
+#include "WordCodec.hpp"
+
+#ifndef _WIN32
+
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+using namespace RemoteProtocol;
+
+// Decodes a batch encoded as by WordCodec::encodeBatch, dropping a truncated word
+static void decodeBatch(const std::vector<char> &payload, QueryBatch &batch)
+{
+	if (payload.size() < sizeof(int32_t)) {
+		return;
+	}
+	const jint *p = reinterpret_cast<const jint *>(payload.data());
+	const jint *end = p + payload.size() / sizeof(jint);
+	jint numQueries = *p++;
+	for (jint i = 0; i < numQueries; i++) {
+		batch.push_back(Word());
+		p = WordCodec::decodeWord(p, end, batch.back());
+		if (!p) {
+			batch.pop_back();
+			break;
+		}
+	}
+}
+
+std::shared_ptr<RemoteConnection> RemoteConnection::connect(const char *socketPath)
+{
+	std::shared_ptr<RemoteConnection> result;
+
+	struct sockaddr_un addr;
+	std::memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	if (std::strlen(socketPath) >= sizeof(addr.sun_path)) {
+		return result;
+	}
+	std::strcpy(addr.sun_path, socketPath);
+
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0) {
+		return result;
+	}
+	configureSocket(fd);
+	if (::connect(fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) != 0) {
+		close(fd);
+		return result;
+	}
+
+	std::string segmentName;
+	void *segment = createSegment(segmentName);
+	if (!segment) {
+		close(fd);
+		return result;
+	}
+
+	// The segment name is sent over the socket, as the rings cannot be used
+	// before the daemon has mapped them.
+	MessageHeader hdr;
+	std::memset(&hdr, 0, sizeof(hdr));
+	hdr.code = HELLO;
+	hdr.payloadLen = segmentName.size();
+	MessageHeader resp;
+	bool ok = sendAll(fd, &hdr, sizeof(hdr))
+		&& sendAll(fd, segmentName.data(), segmentName.size())
+		&& receiveAll(fd, &resp, sizeof(resp))
+		&& resp.code == STATUS_OK;
+	unlinkSegment(segmentName);
+
+	if (!ok) {
+		releaseSegment(segment);
+		close(fd);
+		return result;
+	}
+
+	result.reset(new RemoteConnection(fd, segment));
+	return result;
+}
+
+RemoteConnection::RemoteConnection(int fd, void *segment)
+	: m_fd(fd), m_segment(segment), m_channel(new Channel(fd, segment, true)), m_cancel(cancelControl(segment)),
+	  m_broken(false), m_lastSeq(0), m_activeSeq(0), m_activeBudget(NULL)
+{}
+
+RemoteConnection::~RemoteConnection(void)
+{
+	delete m_channel;
+	close(m_fd);
+	releaseSegment(m_segment);
+}
+
+bool RemoteConnection::call(int32_t op, uint64_t id, int64_t arg, const void *payload, size_t payloadLen,
+		MessageHeader &resp, std::vector<char> *respPayload, const Budget *budget)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (m_broken || payloadLen > MAX_PAYLOAD_LEN) {
+		return false;
+	}
+
+	MessageHeader hdr;
+	std::memset(&hdr, 0, sizeof(hdr));
+	hdr.code = op;
+	hdr.seq = ++m_lastSeq ? m_lastSeq : ++m_lastSeq;
+	hdr.id = id;
+	hdr.arg = arg;
+	hdr.payloadLen = payloadLen;
+
+	if (budget) {
+		m_activeBudget.store(budget);
+		m_activeSeq.store(hdr.seq);
+		// A cancellation that came before the request was published
+		if (budget->cancelled()) {
+			m_cancel->cancelSeq.store(hdr.seq);
+		}
+	}
+
+	bool ok = m_channel->send(hdr, payload) && m_channel->receiveHeader(resp)
+		&& resp.payloadLen <= MAX_PAYLOAD_LEN;
+	if (ok) {
+		if (respPayload) {
+			respPayload->resize(resp.payloadLen);
+			ok = m_channel->receivePayload(respPayload->data(), resp.payloadLen);
+		}
+		else {
+			ok = m_channel->skipPayload(resp.payloadLen);
+		}
+	}
+	if (budget) {
+		m_activeSeq.store(0);
+		m_activeBudget.store(NULL);
+	}
+	if (!ok) {
+		// The daemon has crashed or closed the connection; the state of
+		// the protocol is unknown, so no further requests are attempted.
+		m_broken = true;
+		return false;
+	}
+	return (resp.code != STATUS_ERROR);
+}
+
+void RemoteConnection::cancel(const Budget *budget)
+{
+	// A stale sequence number is harmless, as it is never used again
+	uint32_t seq = m_activeSeq.load();
+	if (seq && m_activeBudget.load() == budget) {
+		m_cancel->cancelSeq.store(seq);
+	}
+}
+
+uint64_t RemoteConnection::createSession(const std::vector<std::string> &algNames)
+{
+	std::string names;
+	for (std::vector<std::string>::const_iterator it = algNames.begin(); it != algNames.end(); ++it) {
+		names += *it;
+		names += '\0';
+	}
+	MessageHeader resp;
+	if (!call(CREATE_SESSION, 0, 0, names.data(), names.size(), resp, NULL)) {
+		return 0;
+	}
+	return static_cast<uint64_t>(resp.arg);
+}
+
+void RemoteConnection::disposeSession(uint64_t sessionId)
+{
+	MessageHeader resp;
+	call(DISPOSE_SESSION, sessionId, 0, NULL, 0, resp, NULL);
+}
+
+LibalfLearner *RemoteConnection::createLearner(const std::shared_ptr<RemoteConnection> &self, uint64_t sessionId,
+		jint algorithmId, jint alphabetSize, size_t otherOptsLen, const jint *otherOpts)
+{
+	std::vector<int32_t> payload;
+	payload.push_back(algorithmId);
+	payload.push_back(alphabetSize);
+	payload.insert(payload.end(), otherOpts, otherOpts + otherOptsLen);
+
+	MessageHeader resp;
+	std::vector<char> respPayload;
+	if (!call(CREATE_LEARNER, 0, static_cast<int64_t>(sessionId), payload.data(), payload.size() * sizeof(int32_t), resp, &respPayload)
+			|| respPayload.size() != sizeof(int32_t)) {
+		return NULL;
+	}
+	int32_t booleanAnswers;
+	std::memcpy(&booleanAnswers, respPayload.data(), sizeof(booleanAnswers));
+	return new RemoteLearner(self, static_cast<uint64_t>(resp.arg), booleanAnswers != 0);
+}
+
+
+RemoteLearner::RemoteLearner(const std::shared_ptr<RemoteConnection> &conn, uint64_t id, bool booleanAnswers)
+	: m_conn(conn), m_id(id), m_booleanAnswers(booleanAnswers), m_timedOut(false), m_retained(false), m_hasConjecture(false)
+{}
+
+RemoteLearner::~RemoteLearner(void)
+{
+	MessageHeader resp;
+	m_conn->call(DISPOSE_LEARNER, m_id, 0, NULL, 0, resp, NULL);
+}
+
+bool RemoteLearner::flushAnswers(void)
+{
+	if (m_pendingAnswers.empty()) {
+		return true;
+	}
+	std::vector<int32_t> payload;
+	payload.reserve(1 + m_pendingWords.size() + m_pendingAnswers.size());
+	payload.push_back(static_cast<int32_t>(m_pendingAnswers.size()));
+	payload.insert(payload.end(), m_pendingWords.begin(), m_pendingWords.end());
+	payload.insert(payload.end(), m_pendingAnswers.begin(), m_pendingAnswers.end());
+	m_pendingWords.clear();
+	m_pendingAnswers.clear();
+
+	MessageHeader resp;
+	return m_conn->call(ADD_ANSWERS, m_id, 0, payload.data(), payload.size() * sizeof(int32_t), resp, NULL)
+		&& resp.arg != 0;
+}
+
+bool RemoteLearner::addEncodedAnswer(Word &w, jint answer)
+{
+	m_pendingWords.push_back(static_cast<int32_t>(w.size()));
+	m_pendingWords.insert(m_pendingWords.end(), w.begin(), w.end());
+	m_pendingAnswers.push_back(answer);
+	return true;
+}
+
+bool RemoteLearner::addEncodedAnswers(QueryBatch &batch, const jint *answers)
+{
+	for (QueryBatch::iterator it = batch.begin(); it != batch.end(); ++it) {
+		addEncodedAnswer(*it, *answers++);
+	}
+	return flushAnswers();
+}
+
+size_t RemoteLearner::addEncodedSamples(size_t numSamples, const jint *samplesEnc, const jint *samplesEnd, const jint *outputs)
+{
+	// Buffered answers are added first, as they were given first; as they
+	// were already accepted, a conflict among them is not reported here.
+	flushAnswers();
+
+	std::vector<int32_t> payload;
+	payload.reserve(1 + (samplesEnd - samplesEnc) + numSamples);
+	payload.push_back(static_cast<int32_t>(numSamples));
+	payload.insert(payload.end(), samplesEnc, samplesEnd);
+	payload.insert(payload.end(), outputs, outputs + numSamples);
+
+	MessageHeader resp;
+	if (!m_conn->call(ADD_SAMPLES, m_id, 0, payload.data(), payload.size() * sizeof(int32_t), resp, NULL)
+			|| resp.arg < 0 || static_cast<uint64_t>(resp.arg) > numSamples) {
+		return 0;
+	}
+	return static_cast<size_t>(resp.arg);
+}
+
+bool RemoteLearner::receiveConjecture(const MessageHeader &resp) const
+{
+	switch (resp.code) {
+	case STATUS_CONJECTURE:
+		m_timedOut = false;
+		m_retained = false;
+		m_hasConjecture = true;
+		return true;
+	case STATUS_TIMED_OUT:
+		// Report the conjecture as available, but fail to encode it, so that
+		// the caller reports the expired budget. If a conjecture was derived,
+		// the daemon keeps it.
+		m_conjecture.clear();
+		m_timedOut = true;
+		m_retained = (resp.arg == 1);
+		m_hasConjecture |= m_retained;
+		return true;
+	default:
+		return false;
+	}
+}
+
+void RemoteLearner::cancel(void)
+{
+	budget().cancel();
+	m_conn->cancel(&budget());
+}
+
+bool RemoteLearner::advance(void)
+{
+	flushAnswers();
+
+	MessageHeader resp;
+	std::vector<char> conjecture;
+	if (!m_conn->call(ADVANCE, m_id, budget().remainingMillis(), NULL, 0, resp, &conjecture, &budget())) {
+		return false;
+	}
+	if (resp.code == STATUS_CONJECTURE) {
+		m_conjecture.swap(conjecture);
+	}
+	return receiveConjecture(resp);
+}
+
+QueryBatch *RemoteLearner::getQueries(void)
+{
+	QueryBatch *batch = new QueryBatch();
+	flushAnswers();
+
+	MessageHeader resp;
+	std::vector<char> payload;
+	if (m_conn->call(GET_QUERIES, m_id, 0, NULL, 0, resp, &payload)) {
+		decodeBatch(payload, *batch);
+	}
+	return batch;
+}
+
+QueryCursor *RemoteLearner::openQueryCursor(void)
+{
+	flushAnswers();
+
+	MessageHeader resp;
+	if (!m_conn->call(OPEN_QUERY_CURSOR, m_id, 0, NULL, 0, resp, NULL)) {
+		return LibalfLearner::openQueryCursor();
+	}
+	return new RemoteQueryCursor(m_conn, static_cast<uint64_t>(resp.arg));
+}
+
+void RemoteLearner::addCounterExample(Word &ce)
+{
+	flushAnswers();
+
+	std::vector<int32_t> payload(ce.begin(), ce.end());
+	MessageHeader resp;
+	m_conn->call(ADD_COUNTEREXAMPLE, m_id, 0, payload.data(), payload.size() * sizeof(int32_t), resp, NULL);
+}
+
+bool RemoteLearner::booleanAnswers(void) const
+{
+	return m_booleanAnswers;
+}
+
+bool RemoteLearner::hasConjecture(void) const
+{
+	return m_hasConjecture;
+}
+
+size_t RemoteLearner::computeConjectureSize(void) const
+{
+	if (m_retained && !budget().expired()) {
+		MessageHeader resp;
+		std::vector<char> conjecture;
+		if (m_conn->call(GET_CONJECTURE, m_id, budget().remainingMillis(), NULL, 0, resp, &conjecture, &budget())) {
+			if (resp.code == STATUS_CONJECTURE) {
+				m_conjecture.swap(conjecture);
+			}
+			receiveConjecture(resp);
+		}
+	}
+	return m_conjecture.size();
+}
+
+bool RemoteLearner::encodeConjecture(jbyte *buf, size_t size) const
+{
+	if (m_timedOut || size != m_conjecture.size()) {
+		return false;
+	}
+	std::memcpy(buf, m_conjecture.data(), size);
+	return true;
+}
+
+bool RemoteLearner::setCounterExampleShortening(bool enable)
+{
+	MessageHeader resp;
+	if (!m_conn->call(SET_CE_SHORTENING, m_id, enable ? 1 : 0, NULL, 0, resp, NULL)) {
+		return false;
+	}
+	return (resp.arg != 0);
+}
+
+const CEShortening::Stats *RemoteLearner::getCounterExampleStats(void) const
+{
+	MessageHeader resp;
+	std::vector<char> payload;
+	if (!m_conn->call(GET_CE_STATS, m_id, 0, NULL, 0, resp, &payload) || payload.size() != 5 * sizeof(jlong)) {
+		return NULL;
+	}
+	const jlong *stats = reinterpret_cast<const jlong *>(payload.data());
+	m_ceStats.counterExamples = stats[0];
+	m_ceStats.shortened = stats[1];
+	m_ceStats.symbolsIn = stats[2];
+	m_ceStats.symbolsOut = stats[3];
+	m_ceStats.knowledgeHits = stats[4];
+	return &m_ceStats;
+}
+
+
+RemoteQueryCursor::~RemoteQueryCursor(void)
+{
+	MessageHeader resp;
+	m_conn->call(CLOSE_QUERY_CURSOR, m_id, 0, NULL, 0, resp, NULL);
+}
+
+bool RemoteQueryCursor::nextPage(QueryBatch &page, size_t maxQueries, size_t maxInts)
+{
+	const size_t maxLimit = 0x7fffffff;
+	int32_t limits[] = {
+		static_cast<int32_t>(std::min(maxQueries, maxLimit)),
+		static_cast<int32_t>(std::min(maxInts, maxLimit))
+	};
+	MessageHeader resp;
+	std::vector<char> payload;
+	if (!m_conn->call(FETCH_QUERY_PAGE, m_id, 0, limits, sizeof(limits), resp, &payload) || resp.arg == 0) {
+		return false;
+	}
+	decodeBatch(payload, page);
+	return !page.empty();
+}
+
+#else // _WIN32
+
+std::shared_ptr<RemoteConnection> RemoteConnection::connect(const char *socketPath)
+{
+	return std::shared_ptr<RemoteConnection>();
+}
+
+uint64_t RemoteConnection::createSession(const std::vector<std::string> &algNames)
+{
+	return 0;
+}
+
+void RemoteConnection::disposeSession(uint64_t sessionId)
+{}
+
+LibalfLearner *RemoteConnection::createLearner(const std::shared_ptr<RemoteConnection> &self, uint64_t sessionId,
+		jint algorithmId, jint alphabetSize, size_t otherOptsLen, const jint *otherOpts)
+{
+	return NULL;
+}
+
+RemoteConnection::~RemoteConnection(void)
+{}
+
+#endif // _WIN32
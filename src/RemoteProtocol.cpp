@@ -0,0 +1,287 @@
+/* Copyright (C) 2015 TU Dortmund
+ * This file is part of LearnLib, http://www.learnlib.de/.
+ * 
+ * LearnLib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 3.0 as published by the Free Software Foundation.
+ * 
+ * LearnLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with LearnLib; if not, see
+ * <http://www.gnu.de/documents/lgpl.en.html>.
+ */
+
+// RemoteProtocol.cpp
+// Implementation of the shared memory rings and the message channel
+
+// The learner daemon is only available on POSIX systems
+#ifndef _WIN32
+
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <thread>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+
+#include "RemoteProtocol.hpp"
+
+namespace RemoteProtocol {
+
+#ifdef MSG_NOSIGNAL
+static const int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+static const int SEND_FLAGS = 0; // SO_NOSIGPIPE is set on the socket instead
+#endif
+
+// Number of unsuccessful polls of a ring before backing off to sleeping
+static const unsigned SPIN_LIMIT = 1024;
+// Number of sleeps between two checks whether the peer is still alive
+static const unsigned LIVENESS_INTERVAL = 64;
+
+static bool peerAlive(int fd)
+{
+	struct pollfd pfd;
+	pfd.fd = fd;
+	pfd.events = 0;
+	pfd.revents = 0;
+	if (poll(&pfd, 1, 0) < 0) {
+		return errno == EINTR;
+	}
+	return !(pfd.revents & (POLLHUP | POLLERR | POLLNVAL));
+}
+
+/*
+ * Waits for progress of the peer: spins for a while, then sleeps for short
+ * intervals while periodically checking that the peer is still connected.
+ */
+class Backoff {
+public:
+	Backoff(int fd) : m_fd(fd), m_rounds(0) {}
+
+	bool wait(void)
+	{
+		m_rounds++;
+		if (m_rounds < SPIN_LIMIT) {
+			std::this_thread::yield();
+			return true;
+		}
+		struct timespec ts = { 0, 20000 };
+		nanosleep(&ts, NULL);
+		if ((m_rounds - SPIN_LIMIT) % LIVENESS_INTERVAL == 0) {
+			return peerAlive(m_fd);
+		}
+		return true;
+	}
+
+	void reset(void) { m_rounds = 0; }
+
+private:
+	int m_fd;
+	unsigned m_rounds;
+};
+
+bool Ring::write(const void *data, size_t len, int peerFd)
+{
+	const char *p = static_cast<const char *>(data);
+	uint64_t head = m_ctrl->head.load(std::memory_order_relaxed);
+	Backoff backoff(peerFd);
+
+	while (len) {
+		uint64_t tail = m_ctrl->tail.load(std::memory_order_acquire);
+		size_t space = RING_CAPACITY - static_cast<size_t>(head - tail);
+		if (!space) {
+			if (!backoff.wait()) {
+				return false;
+			}
+			continue;
+		}
+		backoff.reset();
+
+		size_t pos = static_cast<size_t>(head % RING_CAPACITY);
+		size_t chunk = std::min(std::min(space, len), RING_CAPACITY - pos);
+		std::memcpy(m_data + pos, p, chunk);
+		p += chunk;
+		len -= chunk;
+		head += chunk;
+		m_ctrl->head.store(head, std::memory_order_release);
+	}
+	return true;
+}
+
+bool Ring::read(void *data, size_t len, int peerFd)
+{
+	char *p = static_cast<char *>(data);
+	uint64_t tail = m_ctrl->tail.load(std::memory_order_relaxed);
+	Backoff backoff(peerFd);
+
+	while (len) {
+		uint64_t head = m_ctrl->head.load(std::memory_order_acquire);
+		size_t avail = static_cast<size_t>(head - tail);
+		if (!avail) {
+			if (!backoff.wait()) {
+				return false;
+			}
+			continue;
+		}
+		backoff.reset();
+
+		size_t pos = static_cast<size_t>(tail % RING_CAPACITY);
+		size_t chunk = std::min(std::min(avail, len), RING_CAPACITY - pos);
+		if (p) {
+			std::memcpy(p, m_data + pos, chunk);
+			p += chunk;
+		}
+		len -= chunk;
+		tail += chunk;
+		m_ctrl->tail.store(tail, std::memory_order_release);
+	}
+	return true;
+}
+
+static void *ringAt(void *segment, int idx)
+{
+	return static_cast<char *>(segment) + idx * (sizeof(RingControl) + RING_CAPACITY);
+}
+
+Channel::Channel(int fd, void *segment, bool client)
+	: m_fd(fd), m_out(ringAt(segment, client ? 0 : 1)), m_in(ringAt(segment, client ? 1 : 0))
+{}
+
+bool Channel::send(const MessageHeader &hdr, const void *payload)
+{
+	if (!sendAll(m_fd, &hdr, sizeof(hdr))) {
+		return false;
+	}
+	return m_out.write(payload, hdr.payloadLen, m_fd);
+}
+
+bool Channel::receiveHeader(MessageHeader &hdr)
+{
+	return receiveAll(m_fd, &hdr, sizeof(hdr));
+}
+
+bool Channel::receivePayload(void *buf, size_t len)
+{
+	return m_in.read(buf, len, m_fd);
+}
+
+bool Channel::skipPayload(size_t len)
+{
+	return m_in.read(NULL, len, m_fd);
+}
+
+void configureSocket(int fd)
+{
+#ifdef SO_NOSIGPIPE
+	int on = 1;
+	setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#else
+	(void)fd;
+#endif
+}
+
+void *createSegment(std::string &name)
+{
+	static std::atomic<unsigned> counter(0);
+	char buf[64];
+	snprintf(buf, sizeof(buf), "/learnlib-libalf-%ld-%u", static_cast<long>(getpid()), counter.fetch_add(1));
+	name = buf;
+
+	int fd = shm_open(buf, O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+	if (fd < 0) {
+		return NULL;
+	}
+	void *segment = MAP_FAILED;
+	if (ftruncate(fd, SEGMENT_SIZE) == 0) {
+		segment = mmap(NULL, SEGMENT_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	}
+	close(fd);
+	if (segment == MAP_FAILED) {
+		shm_unlink(buf);
+		return NULL;
+	}
+	// The rings start out empty, as the segment is zero-filled
+	return segment;
+}
+
+void *openSegment(const char *name)
+{
+	int fd = shm_open(name, O_RDWR, 0);
+	if (fd < 0) {
+		return NULL;
+	}
+	// Accessing pages beyond the end of a smaller object raises SIGBUS
+	struct stat st;
+	if (fstat(fd, &st) != 0 || static_cast<uint64_t>(st.st_size) < SEGMENT_SIZE) {
+		close(fd);
+		return NULL;
+	}
+	void *segment = mmap(NULL, SEGMENT_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	return (segment == MAP_FAILED) ? NULL : segment;
+}
+
+void unlinkSegment(const std::string &name)
+{
+	shm_unlink(name.c_str());
+}
+
+void releaseSegment(void *segment)
+{
+	munmap(segment, SEGMENT_SIZE);
+}
+
+CancelControl *cancelControl(void *segment)
+{
+	return static_cast<CancelControl *>(ringAt(segment, 2));
+}
+
+bool sendAll(int fd, const void *data, size_t len)
+{
+	const char *p = static_cast<const char *>(data);
+	while (len) {
+		ssize_t n = ::send(fd, p, len, SEND_FLAGS);
+		if (n < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return false;
+		}
+		p += n;
+		len -= static_cast<size_t>(n);
+	}
+	return true;
+}
+
+bool receiveAll(int fd, void *data, size_t len)
+{
+	char *p = static_cast<char *>(data);
+	while (len) {
+		ssize_t n = ::recv(fd, p, len, 0);
+		if (n < 0 && errno == EINTR) {
+			continue;
+		}
+		if (n <= 0) {
+			return false;
+		}
+		p += n;
+		len -= static_cast<size_t>(n);
+	}
+	return true;
+}
+
+};
+
+#endif // _WIN32
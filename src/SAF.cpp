@@ -26,9 +26,13 @@
 #include <arpa/inet.h>
 #endif
 
+#include <atomic>
+#include <algorithm>
+
 #include <jni.h>
 
 #include "SAF.hpp"
+#include "ThreadPool.hpp"
 
 namespace SAF {
 
@@ -55,6 +59,11 @@ public:
 		return m_array;
 	}
 
+	inline size_t position() const
+	{
+		return static_cast<const char *>(m_curr) - static_cast<const char *>(m_array);
+	}
+
 	template<class T>
 	void write(T val)
 	{
@@ -82,245 +91,305 @@ void writeHeader(Sink &sink, AutomatonType type)
 }
 
 
-typedef std::map<int, std::set<int> > StateTransitions;
-typedef std::map<int, StateTransitions > Transitions;
+// Number of states between two checks of the budget
+static const int BUDGET_CHECK_INTERVAL = 1024;
+
+// Minimum size of an encoding (in bytes) for the transitions to be written
+// in parallel
+static std::atomic<size_t> g_parallelThreshold(16 << 20);
+
+// Number of state ranges per worker thread, for load balancing
+static const unsigned CHUNKS_PER_THREAD = 4;
 
-size_t computeNFASize(const libalf::finite_automaton &fa)
+void setParallelThreshold(size_t minBytes)
 {
-	int alphabetSize = fa.input_alphabet_size;
-	int numStates = fa.state_count;
+	g_parallelThreshold.store(minBytes);
+}
 
-	size_t numWords = 3; // header/automaton type + input alphabet size + state count
-	numWords += fa.initial_states.size() + 1; // initial state set
-	numWords += (numStates - 1)/32 + 1; // acceptance info
-	numWords += numStates * alphabetSize; // transition set sizes
-
-	const Transitions &transitions = fa.transitions;
-	Transitions::const_iterator it = transitions.begin();
-	for (int i = 0; i < numStates; i++) {
-		if (it == transitions.end() || it->first != i) {
-			Transitions::const_iterator it2 = transitions.find(i);
-			if (it2 != transitions.end()) {
-				it = it2;
-			}
-		}
+static inline bool interrupted(const Budget *budget, int state)
+{
+	return (budget && state % BUDGET_CHECK_INTERVAL == 0 && budget->expired());
+}
 
-		if (it != transitions.end() && it->first == i) {
-			const StateTransitions &strans = it->second;
-			StateTransitions::const_iterator sit = strans.begin();
-			for (int j = 0; j < alphabetSize; j++) {
-				if (sit == strans.end() || sit->first != j) {
-					StateTransitions::const_iterator sit2 = strans.find(j);
-					if (sit2 != strans.end()) {
-						sit = sit2;
-					}
-				}
-
-				if (sit != strans.end() && sit->first == j) {
-					numWords += sit->second.size();
-					++sit;
-				}
-			}
-			++it;
-		}
-	}
+size_t computeNFASize(const FlatAutomaton &fa)
+{
+	size_t numWords = 3; // header/automaton type + input alphabet size + state count
+	numWords += fa.initialStates().size() + 1; // initial state set
+	numWords += fa.acceptance().size(); // acceptance info
+	numWords += fa.offsets().size() - 1; // transition set sizes
+	numWords += fa.targets().size(); // transition targets
 
 	size_t size = numWords * 4;
 
 	return size;
 }
 
-void writeAcceptance(Sink &snk, const libalf::finite_automaton &fa)
+void writeAcceptance(Sink &snk, const FlatAutomaton &fa)
 {
-	jint currAcc = 0;
-	jint currMask = 1;
+	const std::vector<uint32_t> &acceptance = fa.acceptance();
+	for (size_t i = 0; i < acceptance.size(); i++) {
+		snk.writeInt32(static_cast<jint>(acceptance[i]));
+	}
+}
 
-	std::map<int, bool>::const_iterator it = fa.output_mapping.begin();
+void writeSet(Sink &snk, const int32_t *begin, const int32_t *end)
+{
+	snk.writeInt32(static_cast<jint>(end - begin));
+	for (const int32_t *p = begin; p != end; ++p) {
+		snk.writeInt32(*p);
+	}
+}
 
-	int numStates = fa.state_count;
+/*
+ * Offset of the transitions of the given state, relative to the start of
+ * the transition section. For NFAs, this is obtained from the CSR offsets,
+ * which already form the prefix sum over the transition set sizes.
+ */
+size_t nfaRowOffset(const FlatAutomaton &fa, int state)
+{
+	size_t cell = static_cast<size_t>(state) * fa.alphabetSize();
+	return (cell + fa.offsets()[cell]) * 4;
+}
 
-	for (int i = 0; i < numStates; i++) {
-		if (i % 32 == 0 && i != 0) {
-			snk.writeInt32(currAcc);
-			currAcc = 0;
-			currMask = 1;
-		}
+bool writeNFATransitions(Sink &snk, const FlatAutomaton &fa, int begin, int end, const Budget *budget)
+{
+	int alphabetSize = fa.alphabetSize();
+	const int32_t *offsets = fa.offsets().data();
+	const int32_t *targets = fa.targets().data();
 
-		if (it == fa.output_mapping.end() || it->first != i) {
-			std::map<int, bool>::const_iterator it2 = fa.output_mapping.find(i);
-			if (it2 != fa.output_mapping.end()) {
-				it = it2;
-			}
-		}
-		bool acc = false;
-		if (it != fa.output_mapping.end() && it->first == i) {
-			acc = it->second;
-			++it;
+	for (int i = begin; i < end; i++) {
+		if (interrupted(budget, i)) {
+			return false;
 		}
-
-		if (acc) {
-			currAcc |= currMask;
+		const int32_t *rowOffsets = offsets + static_cast<size_t>(i) * alphabetSize;
+		for (int j = 0; j < alphabetSize; j++) {
+			writeSet(snk, targets + rowOffsets[j], targets + rowOffsets[j + 1]);
 		}
-		currMask <<= 1;
 	}
-	snk.writeInt32(currAcc);
+	return true;
 }
 
-void writeSet(Sink &snk, const std::set<int> &set)
+size_t computeDFASize(const FlatAutomaton &fa)
 {
-	snk.writeInt32(static_cast<jint>(set.size()));
-	for (std::set<int>::const_iterator it = set.begin(); it != set.end(); ++it) {
-		snk.writeInt32(*it);
-	}
+	size_t size =
+		(4 // header/automaton type + input alphabet size + state count + initial state id
+		+ fa.acceptance().size() // acceptance info
+		+ fa.table().size()) * 4; // transition info
+
+	return size;
 }
 
-void writeNFATransitions(Sink &snk, int alphabetSize, int numStates, const Transitions &transitions)
+
+size_t dfaRowOffset(const FlatAutomaton &fa, int state)
 {
-	Transitions::const_iterator it = transitions.begin();
-	for (int i = 0; i < numStates; i++) {
-		if (it == transitions.end() || it->first != i) {
-			Transitions::const_iterator it2 = transitions.find(i);
-			if (it2 != transitions.end()) {
-				it = it2;
-			}
-		}
+	return static_cast<size_t>(state) * fa.alphabetSize() * 4;
+}
 
-		if (it != transitions.end() && it->first == i) {
-			const StateTransitions &strans = it->second;
-			StateTransitions::const_iterator sit = strans.begin();
-			for (int j = 0; j < alphabetSize; j++) {
-				if (sit == strans.end() || sit->first != j) {
-					StateTransitions::const_iterator sit2 = strans.find(j);
-					if (sit2 != strans.end()) {
-						sit = sit2;
-					}
-				}
-
-				if (sit != strans.end() && sit->first == j) {
-					writeSet(snk, sit->second);
-					++sit;
-				}
-				else {
-					snk.writeInt32(0);
-				}
-			}
-			++it;
+bool writeDFATransitions(Sink &snk, const FlatAutomaton &fa, int begin, int end, const Budget *budget)
+{
+	int alphabetSize = fa.alphabetSize();
+	const int32_t *table = fa.table().data();
+
+	for (int i = begin; i < end; i++) {
+		if (interrupted(budget, i)) {
+			return false;
 		}
-		else {
-			for (int j = 0; j < alphabetSize; j++) {
-				snk.writeInt32(0);
-			}
+		const int32_t *row = table + static_cast<size_t>(i) * alphabetSize;
+		for (int j = 0; j < alphabetSize; j++) {
+			snk.writeInt32(row[j]);
 		}
 	}
+	return true;
 }
 
-size_t computeDFASize(const libalf::finite_automaton &fa)
+size_t computeMealySize(const FlatMealyMachine &mm)
 {
-	int alphabetSize = fa.input_alphabet_size;
-	int numStates = fa.state_count;
-
 	size_t size =
 		(4 // header/automaton type + input alphabet size + state count + initial state id
-		+ (numStates - 1)/32 + 1 // acceptance info
-		+ numStates * alphabetSize) * 4; // transition info
+		+ 2 * mm.table().size()) * 4; // transition info (successor, output)
 
 	return size;
 }
 
+size_t mealyRowOffset(const FlatMealyMachine &mm, int state)
+{
+	return static_cast<size_t>(state) * mm.alphabetSize() * 8;
+}
 
-void writeDFATransitions(Sink &snk, int alphabetSize, int numStates, const Transitions &transitions)
+bool writeMealyTransitions(Sink &snk, const FlatMealyMachine &mm, int begin, int end, const Budget *budget)
 {
-	Transitions::const_iterator it = transitions.begin();
-
-	for (int i = 0; i < numStates; i++) {
-		if (it == transitions.end() || it->first != i) {
-			Transitions::const_iterator it2 = transitions.find(i);
-			if (it2 != transitions.end()) {
-				it = it2;
-			}
-		}
+	int alphabetSize = mm.alphabetSize();
+	const int32_t *table = mm.table().data();
+	const int32_t *outputs = mm.outputs().data();
 
-		if (it != transitions.end() && it->first == i) {
-			const StateTransitions &strans = it->second;
-			StateTransitions::const_iterator sit = strans.begin();
-			for (int j = 0; j < alphabetSize; j++) {
-				if (sit == strans.end() || sit->first != j) {
-					StateTransitions::const_iterator sit2 = strans.find(j);
-					if (sit2 != strans.end()) {
-						sit = sit2;
-					}
-				}
-
-				if (sit != strans.end() && sit->first == j) {
-					const std::set<int> &targets = sit->second;
-					if (targets.empty()) {
-						snk.writeInt32(-1);
-					}
-					else {
-						snk.writeInt32(*targets.begin());
-					}
-					++sit;
-				}
-				else {
-					snk.writeInt32(-1);
-				}
-			}
-			++it;
+	for (int i = begin; i < end; i++) {
+		if (interrupted(budget, i)) {
+			return false;
 		}
-		else {
-			for (int j = 0; j < alphabetSize; j++) {
-				snk.writeInt32(-1);
-			}
+		size_t rowStart = static_cast<size_t>(i) * alphabetSize;
+		for (int j = 0; j < alphabetSize; j++) {
+			snk.writeInt32(table[rowStart + j]);
+			snk.writeInt32(outputs[rowStart + j]);
+		}
+	}
+	return true;
+}
+
+/*
+ * Writes the transitions of the states [begin, end), starting at the current
+ * position of the sink. Above the size threshold, the states are split into
+ * ranges which are written independently by the shared thread pool; since
+ * the offset of each range is known in advance, the output is identical to
+ * the one written sequentially.
+ */
+template<class FA>
+bool writeTransitions(ArraySink &snk, size_t totalSize, const FA &fa, int begin, int end,
+		bool (*writer)(Sink &, const FA &, int, int, const Budget *),
+		size_t (*rowOffset)(const FA &, int), const Budget *budget)
+{
+	int numStates = end - begin;
+	if (totalSize < g_parallelThreshold.load() || numStates < 2) {
+		return writer(snk, fa, begin, end, budget);
+	}
+
+	std::shared_ptr<ThreadPool> pool = ThreadPool::shared();
+	size_t numChunks = std::min(static_cast<size_t>(numStates), static_cast<size_t>(pool->size()) * CHUNKS_PER_THREAD);
+	if (numChunks < 2) {
+		return writer(snk, fa, begin, end, budget);
+	}
+
+	char *base = static_cast<char *>(snk.getArray()) + snk.position();
+	size_t baseOffset = rowOffset(fa, begin);
+	std::atomic<bool> complete(true);
+
+	pool->parallelFor(numChunks, [&](size_t chunk) {
+		int chunkBegin = begin + static_cast<int>(numStates * chunk / numChunks);
+		int chunkEnd = begin + static_cast<int>(numStates * (chunk + 1) / numChunks);
+		size_t from = rowOffset(fa, chunkBegin) - baseOffset;
+		size_t to = rowOffset(fa, chunkEnd) - baseOffset;
+		ArraySink chunkSnk(base + from, to - from);
+		if (!writer(chunkSnk, fa, chunkBegin, chunkEnd, budget)) {
+			complete.store(false);
 		}
+	});
+
+	return complete.load();
+}
+
+template<class FA>
+size_t computePartSize(const FA &fa, int begin, int end,
+		size_t (*computeSize)(const FA &), size_t (*rowOffset)(const FA &, int))
+{
+	size_t size = rowOffset(fa, end) - rowOffset(fa, begin);
+	if (begin == 0) {
+		size += computeSize(fa) - rowOffset(fa, fa.numStates());
 	}
+	return size;
 }
 
-void writeNFA(Sink &snk, const libalf::finite_automaton &fa)
+bool writeNFA(ArraySink &snk, size_t size, const FlatAutomaton &fa, int begin, int end, const Budget *budget)
 {
-	writeHeader(snk, NFA);
-	int alphabetSize = fa.input_alphabet_size;
-	snk.writeInt32(alphabetSize);
-	int numStates = fa.state_count;
-	snk.writeInt32(numStates);
+	if (begin == 0) {
+		writeHeader(snk, NFA);
+		snk.writeInt32(fa.alphabetSize());
+		snk.writeInt32(fa.numStates());
 
-	writeSet(snk, fa.initial_states);
+		const std::vector<int32_t> &initial = fa.initialStates();
+		writeSet(snk, initial.data(), initial.data() + initial.size());
 
-	writeAcceptance(snk, fa);
+		writeAcceptance(snk, fa);
+	}
 
-	writeNFATransitions(snk, alphabetSize, numStates, fa.transitions);
+	return writeTransitions(snk, size, fa, begin, end, &writeNFATransitions, &nfaRowOffset, budget);
 }
 
 
-void writeDFA(Sink &snk, const libalf::finite_automaton &fa)
+bool writeDFA(ArraySink &snk, size_t size, const FlatAutomaton &fa, int begin, int end, const Budget *budget)
 {
-	writeHeader(snk, DFA);
-	snk.writeInt32(fa.input_alphabet_size);
-	int numStates = fa.state_count;
-	snk.writeInt32(numStates);
+	if (begin == 0) {
+		writeHeader(snk, DFA);
+		snk.writeInt32(fa.alphabetSize());
+		snk.writeInt32(fa.numStates());
 
-	if (fa.initial_states.size() != 1) {
-		throw std::exception();
+		if (fa.initialStates().size() != 1) {
+			throw std::exception();
+		}
+		int init = fa.initialStates().front();
+		snk.writeInt32(init);
+
+		writeAcceptance(snk, fa);
+	}
+
+	return writeTransitions(snk, size, fa, begin, end, &writeDFATransitions, &dfaRowOffset, budget);
+}
+
+bool writeMealy(ArraySink &snk, size_t size, const FlatMealyMachine &mm, int begin, int end, const Budget *budget)
+{
+	if (begin == 0) {
+		writeHeader(snk, Mealy);
+		snk.writeInt32(mm.alphabetSize());
+		snk.writeInt32(mm.numStates());
+		snk.writeInt32(mm.initialState());
 	}
-	int init = *fa.initial_states.begin();
-	snk.writeInt32(init);
 
-	writeAcceptance(snk, fa);
+	return writeTransitions(snk, size, mm, begin, end, &writeMealyTransitions, &mealyRowOffset, budget);
+}
+
+bool encodeDFA(jbyte *buf, size_t size, const FlatAutomaton &fa, const Budget *budget)
+{
+	ArraySink snk(buf, size);
+
+	return writeDFA(snk, size, fa, 0, fa.numStates(), budget);
+}
+
+bool encodeNFA(jbyte *buf, size_t size, const FlatAutomaton &fa, const Budget *budget)
+{
+	ArraySink snk(buf, size);
+
+	return writeNFA(snk, size, fa, 0, fa.numStates(), budget);
+}
 
-	writeDFATransitions(snk, fa.input_alphabet_size, numStates, fa.transitions);
+bool encodeMealy(jbyte *buf, size_t size, const FlatMealyMachine &mm, const Budget *budget)
+{
+	ArraySink snk(buf, size);
+
+	return writeMealy(snk, size, mm, 0, mm.numStates(), budget);
+}
+
+size_t computeDFAPartSize(const FlatAutomaton &fa, int begin, int end)
+{
+	return computePartSize(fa, begin, end, &computeDFASize, &dfaRowOffset);
 }
 
-void encodeDFA(jbyte *buf, size_t size, const libalf::finite_automaton &fa)
+bool encodeDFAPart(jbyte *buf, size_t size, const FlatAutomaton &fa, int begin, int end, const Budget *budget)
 {
 	ArraySink snk(buf, size);
 
-	writeDFA(snk, fa);
+	return writeDFA(snk, size, fa, begin, end, budget);
+}
+
+size_t computeNFAPartSize(const FlatAutomaton &fa, int begin, int end)
+{
+	return computePartSize(fa, begin, end, &computeNFASize, &nfaRowOffset);
+}
+
+bool encodeNFAPart(jbyte *buf, size_t size, const FlatAutomaton &fa, int begin, int end, const Budget *budget)
+{
+	ArraySink snk(buf, size);
+
+	return writeNFA(snk, size, fa, begin, end, budget);
+}
+
+size_t computeMealyPartSize(const FlatMealyMachine &mm, int begin, int end)
+{
+	return computePartSize(mm, begin, end, &computeMealySize, &mealyRowOffset);
 }
 
-void encodeNFA(jbyte *buf, size_t size, const libalf::finite_automaton &fa)
+bool encodeMealyPart(jbyte *buf, size_t size, const FlatMealyMachine &mm, int begin, int end, const Budget *budget)
 {
 	ArraySink snk(buf, size);
 
-	writeNFA(snk, fa);
+	return writeMealy(snk, size, mm, begin, end, budget);
 }
 
 };
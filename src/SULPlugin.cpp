@@ -0,0 +1,220 @@
+/* Copyright (C) 2015 TU Dortmund
+ * This file is part of LearnLib, http://www.learnlib.de/.
+ * 
+ * LearnLib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 3.0 as published by the Free Software Foundation.
+ * 
+ * LearnLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with LearnLib; if not, see
+ * <http://www.gnu.de/documents/lgpl.en.html>.
+ */
+
+// SULPlugin.cpp
+// Implementation of the SULPlugin class, and JNI method implementations
+// for the SULPlugin class
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+#include <algorithm>
+#include <memory>
+
+#include "SULPlugin.hpp"
+#include "ThreadPool.hpp"
+#include "JNIUtil.hpp"
+
+// Minimum number of queries handed to a single SUL instance at once
+static const size_t MIN_QUERIES_PER_CHUNK = 64;
+
+static void *openLibrary(const char *path)
+{
+#ifdef _WIN32
+	return LoadLibraryA(path);
+#else
+	return dlopen(path, RTLD_NOW | RTLD_LOCAL);
+#endif
+}
+
+static void *lookupSymbol(void *handle, const char *name)
+{
+#ifdef _WIN32
+	return reinterpret_cast<void *>(GetProcAddress(static_cast<HMODULE>(handle), name));
+#else
+	return dlsym(handle, name);
+#endif
+}
+
+static void closeLibrary(void *handle)
+{
+#ifdef _WIN32
+	FreeLibrary(static_cast<HMODULE>(handle));
+#else
+	dlclose(handle);
+#endif
+}
+
+SULPlugin *SULPlugin::load(const char *path, const char *config, unsigned numInstances)
+{
+	void *handle = openLibrary(path);
+	if (!handle) {
+		return NULL;
+	}
+
+	learnlib_sul_entry_point *entry = reinterpret_cast<learnlib_sul_entry_point *>(lookupSymbol(handle, LEARNLIB_SUL_ENTRY_POINT));
+	const learnlib_sul_plugin *plugin = entry ? (*entry)() : NULL;
+	if (!plugin || plugin->abi_version != LEARNLIB_SUL_ABI_VERSION
+			|| !plugin->create || !plugin->destroy || !plugin->reset || !plugin->step) {
+		closeLibrary(handle);
+		return NULL;
+	}
+
+	SULPlugin *sul = new SULPlugin(handle, plugin);
+	numInstances = std::max(1u, numInstances);
+	for (unsigned i = 0; i < numInstances; i++) {
+		void *instance = plugin->create(config);
+		if (!instance) {
+			delete sul;
+			return NULL;
+		}
+		sul->m_instances.push_back(instance);
+		sul->m_idle.push_back(instance);
+	}
+
+	return sul;
+}
+
+SULPlugin::SULPlugin(void *handle, const learnlib_sul_plugin *plugin)
+	: m_handle(handle), m_plugin(plugin)
+{}
+
+SULPlugin::~SULPlugin(void)
+{
+	for (std::vector<void *>::iterator it = m_instances.begin(); it != m_instances.end(); ++it) {
+		m_plugin->destroy(*it);
+	}
+	closeLibrary(m_handle);
+}
+
+void *SULPlugin::acquire(void)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (m_idle.empty()) {
+		m_available.wait(lock);
+	}
+	void *sul = m_idle.back();
+	m_idle.pop_back();
+	return sul;
+}
+
+void SULPlugin::release(void *sul)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_idle.push_back(sul);
+	}
+	m_available.notify_one();
+}
+
+void SULPlugin::answerRange(void *sul, const Word *const *words, size_t numWords, jint *answers) const
+{
+	if (m_plugin->query_batch) {
+		std::vector<int32_t> enc;
+		for (size_t i = 0; i < numWords; i++) {
+			const Word &word = *words[i];
+			enc.push_back(static_cast<int32_t>(word.size()));
+			enc.insert(enc.end(), word.begin(), word.end());
+		}
+		if (m_plugin->query_batch(sul, enc.data(), numWords, answers) == 0) {
+			return;
+		}
+	}
+
+	for (size_t i = 0; i < numWords; i++) {
+		const Word &word = *words[i];
+		int32_t output = m_plugin->reset(sul);
+		for (Word::const_iterator it = word.begin(); it != word.end(); ++it) {
+			output = m_plugin->step(sul, *it);
+		}
+		answers[i] = output;
+	}
+}
+
+void SULPlugin::answerQueries(const QueryBatch &batch, jint *answers)
+{
+	std::vector<const Word *> words;
+	words.reserve(batch.size());
+	for (QueryBatch::const_iterator it = batch.begin(); it != batch.end(); ++it) {
+		words.push_back(&*it);
+	}
+
+	size_t numChunks = std::min(m_instances.size(), words.size() / MIN_QUERIES_PER_CHUNK);
+	if (numChunks < 2) {
+		void *sul = acquire();
+		answerRange(sul, words.data(), words.size(), answers);
+		release(sul);
+		return;
+	}
+
+	std::shared_ptr<ThreadPool> pool = ThreadPool::shared();
+	pool->parallelFor(numChunks, [&](size_t chunk) {
+		size_t begin = words.size() * chunk / numChunks;
+		size_t end = words.size() * (chunk + 1) / numChunks;
+		void *sul = acquire();
+		answerRange(sul, words.data() + begin, end - begin, answers + begin);
+		release(sul);
+	});
+}
+
+// JNI native methods
+
+extern "C" {
+
+/*
+ * Class:     de_learnlib_libalf_SULPlugin
+ * Method:    load
+ * Signature: (Ljava/lang/String;Ljava/lang/String;I)[B
+ */
+JNIEXPORT jbyteArray JNICALL Java_de_learnlib_libalf_SULPlugin_load
+  (JNIEnv *env, jclass clazz, jstring jpath, jstring jconfig, jint numInstances)
+{
+	const char *path = env->GetStringUTFChars(jpath, NULL);
+	const char *config = NULL;
+	if (jconfig) {
+		config = env->GetStringUTFChars(jconfig, NULL);
+	}
+
+	SULPlugin *sul = SULPlugin::load(path, config, static_cast<unsigned>(std::max(numInstances, 1)));
+
+	if (config) {
+		env->ReleaseStringUTFChars(jconfig, config);
+	}
+	env->ReleaseStringUTFChars(jpath, path);
+
+	// Store the pointer as a MembershipOracle, so that it can be passed on
+	// to learners and grids
+	MembershipOracle *oracle = sul;
+	return JNIUtil::createPtr(env, oracle);
+}
+
+/*
+ * Class:     de_learnlib_libalf_SULPlugin
+ * Method:    dispose
+ * Signature: ([B)V
+ */
+JNIEXPORT void JNICALL Java_de_learnlib_libalf_SULPlugin_dispose
+  (JNIEnv *env, jclass clazz, jbyteArray ptr)
+{
+	MembershipOracle *oracle = JNIUtil::extractPtr<MembershipOracle>(env, ptr);
+	delete oracle;
+}
+
+};
@@ -0,0 +1,47 @@
+/* Copyright (C) 2015 TU Dortmund
+ * This file is part of LearnLib, http://www.learnlib.de/.
+ * 
+ * LearnLib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 3.0 as published by the Free Software Foundation.
+ * 
+ * LearnLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with LearnLib; if not, see
+ * <http://www.gnu.de/documents/lgpl.en.html>.
+ */
+
+// ScratchWord.cpp
+// Implementation of the recycling scratch word
+
+#include <iterator>
+
+#include "ScratchWord.hpp"
+
+void ScratchWord::resize(size_t len)
+{
+	size_t size = m_word.size();
+	if (len < size) {
+		Word::iterator it = m_word.begin();
+		std::advance(it, len);
+		m_spare.splice(m_spare.end(), m_word, it, m_word.end());
+		return;
+	}
+	size_t missing = len - size;
+	if (missing == 0) {
+		return;
+	}
+	if (m_spare.size() <= missing) {
+		missing -= m_spare.size();
+		m_word.splice(m_word.end(), m_spare);
+		m_word.resize(len);
+		return;
+	}
+	Word::iterator it = m_spare.begin();
+	std::advance(it, missing);
+	m_word.splice(m_word.end(), m_spare, m_spare.begin(), it);
+}
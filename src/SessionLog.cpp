@@ -0,0 +1,392 @@
+/* Copyright (C) 2015 TU Dortmund
+ * This file is part of LearnLib, http://www.learnlib.de/.
+ * 
+ * LearnLib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 3.0 as published by the Free Software Foundation.
+ * 
+ * LearnLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with LearnLib; if not, see
+ * <http://www.gnu.de/documents/lgpl.en.html>.
+ */
+
+// SessionLog.cpp
+// Implementation of session recording and reading
+
+#include <cstdlib>
+#include <cstring>
+#include <atomic>
+#include <mutex>
+
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+#include "SessionLog.hpp"
+#include "Varint.hpp"
+
+namespace SessionLog {
+
+static const char MAGIC[] = { 'L', 'L', 'R', 'S' };
+static const unsigned char VERSION = 1;
+
+static std::mutex g_dirMutex;
+static bool g_dirInitialized = false;
+static std::string g_dir;
+static std::atomic<unsigned> g_counter(0);
+
+uint64_t hashBatch(const QueryBatch &batch)
+{
+	uint64_t h = 14695981039346656037ull;
+	for (QueryBatch::const_iterator it = batch.begin(); it != batch.end(); ++it) {
+		h = (h ^ it->size()) * 1099511628211ull;
+		for (Word::const_iterator sit = it->begin(); sit != it->end(); ++sit) {
+			h = (h ^ static_cast<uint32_t>(*sit)) * 1099511628211ull;
+		}
+	}
+	return h;
+}
+
+void setRecordingDirectory(const char *dir)
+{
+	std::lock_guard<std::mutex> lock(g_dirMutex);
+	g_dir = dir ? dir : "";
+	g_dirInitialized = true;
+}
+
+static std::string recordingDirectory(void)
+{
+	std::lock_guard<std::mutex> lock(g_dirMutex);
+	if (!g_dirInitialized) {
+		const char *dir = std::getenv("LEARNLIB_LIBALF_RECORD_DIR");
+		g_dir = dir ? dir : "";
+		g_dirInitialized = true;
+	}
+	return g_dir;
+}
+
+
+Recorder *Recorder::create(const std::string &algName, jint alphabetSize, size_t numOpts, const jint *opts)
+{
+	std::string dir = recordingDirectory();
+	if (dir.empty()) {
+		return NULL;
+	}
+
+	char name[64];
+	std::snprintf(name, sizeof(name), "/learner-%ld-%u.llrs", static_cast<long>(getpid()), g_counter.fetch_add(1));
+	std::FILE *file = std::fopen((dir + name).c_str(), "wb");
+	if (!file) {
+		return NULL;
+	}
+
+	Recorder *rec = new Recorder(file);
+	rec->m_buf.insert(rec->m_buf.end(), MAGIC, MAGIC + sizeof(MAGIC));
+	rec->m_buf.push_back(VERSION);
+	rec->m_buf.push_back(INIT);
+	Varint::put(rec->m_buf, algName.size());
+	rec->m_buf.insert(rec->m_buf.end(), algName.begin(), algName.end());
+	Varint::put(rec->m_buf, static_cast<uint32_t>(alphabetSize));
+	Varint::put(rec->m_buf, numOpts);
+	for (size_t i = 0; i < numOpts; i++) {
+		Varint::put(rec->m_buf, Varint::zigZag(opts[i]));
+	}
+	rec->flush();
+	return rec;
+}
+
+Recorder::~Recorder(void)
+{
+	flush();
+	std::fclose(m_file);
+}
+
+void Recorder::flush(void)
+{
+	if (m_failed) {
+		m_buf.clear();
+		return;
+	}
+	bool ok = m_buf.empty() || std::fwrite(m_buf.data(), 1, m_buf.size(), m_file) == m_buf.size();
+	m_buf.clear();
+	if (!ok || std::fflush(m_file) != 0) {
+		m_failed = true;
+	}
+}
+
+void Recorder::putWord(const Word &w)
+{
+	Varint::put(m_buf, w.size());
+	for (Word::const_iterator it = w.begin(); it != w.end(); ++it) {
+		Varint::put(m_buf, static_cast<uint32_t>(*it));
+	}
+}
+
+void Recorder::putWordsWithAnswers(const QueryBatch &words, const jint *answers)
+{
+	Varint::put(m_buf, words.size());
+	for (QueryBatch::const_iterator it = words.begin(); it != words.end(); ++it) {
+		putWord(*it);
+	}
+	for (size_t i = 0; i < words.size(); i++) {
+		Varint::put(m_buf, Varint::zigZag(answers[i]));
+	}
+}
+
+// The log is flushed after each advance, so that it survives a crash of
+// the learner up to the last round.
+void Recorder::recordAdvance(bool conjecture, size_t safSize)
+{
+	m_buf.push_back(ADVANCE);
+	Varint::put(m_buf, conjecture ? 1 : 0);
+	Varint::put(m_buf, safSize);
+	flush();
+}
+
+void Recorder::recordQueries(const QueryBatch &batch)
+{
+	m_buf.push_back(QUERIES);
+	Varint::put(m_buf, batch.size());
+	Varint::put(m_buf, hashBatch(batch));
+}
+
+void Recorder::recordAnswers(const QueryBatch &batch, const jint *answers)
+{
+	m_buf.push_back(ANSWERS);
+	putWordsWithAnswers(batch, answers);
+}
+
+void Recorder::recordCounterExample(const Word &ce)
+{
+	m_buf.push_back(COUNTEREXAMPLE);
+	putWord(ce);
+}
+
+void Recorder::recordSamples(const QueryBatch &samples, const jint *outputs)
+{
+	m_buf.push_back(SAMPLES);
+	putWordsWithAnswers(samples, outputs);
+}
+
+void Recorder::recordCEShortening(bool enable)
+{
+	m_buf.push_back(CE_SHORTENING);
+	Varint::put(m_buf, enable ? 1 : 0);
+}
+
+void Recorder::recordPostProcessing(bool minimize, bool verify)
+{
+	m_buf.push_back(POST_PROCESSING);
+	Varint::put(m_buf, minimize ? 1 : 0);
+	Varint::put(m_buf, verify ? 1 : 0);
+}
+
+void Recorder::recordSpill(jlong maxHotAnswers)
+{
+	m_buf.push_back(SPILL);
+	Varint::put(m_buf, static_cast<uint64_t>(maxHotAnswers));
+}
+
+void Recorder::recordDeadline(jlong millis)
+{
+	m_buf.push_back(DEADLINE);
+	// non-positive values all remove the deadline
+	Varint::put(m_buf, (millis > 0) ? static_cast<uint64_t>(millis) : 0);
+}
+
+void Recorder::recordCancel(void)
+{
+	m_buf.push_back(CANCEL);
+}
+
+void Recorder::recordFork(void)
+{
+	m_buf.push_back(FORK);
+}
+
+
+bool Reader::open(const char *path)
+{
+	std::FILE *file = std::fopen(path, "rb");
+	if (!file) {
+		return false;
+	}
+	m_data.clear();
+	unsigned char buf[1 << 16];
+	size_t n;
+	while ((n = std::fread(buf, 1, sizeof(buf), file)) > 0) {
+		m_data.insert(m_data.end(), buf, buf + n);
+	}
+	std::fclose(file);
+
+	if (m_data.size() < sizeof(MAGIC) + 1 || std::memcmp(m_data.data(), MAGIC, sizeof(MAGIC)) != 0
+			|| m_data[sizeof(MAGIC)] != VERSION) {
+		return false;
+	}
+	rewind();
+	return true;
+}
+
+void Reader::rewind(void)
+{
+	m_pos = sizeof(MAGIC) + 1;
+	m_failed = false;
+}
+
+bool Reader::getInt(jint &value, bool isSigned)
+{
+	const unsigned char *begin = m_data.data();
+	uint64_t raw;
+	const unsigned char *p = Varint::get(begin + m_pos, begin + m_data.size(), raw);
+	if (!p) {
+		return false;
+	}
+	m_pos = static_cast<size_t>(p - begin);
+	value = isSigned ? Varint::unZigZag(raw) : static_cast<jint>(raw);
+	return true;
+}
+
+bool Reader::getLong(jlong &value)
+{
+	const unsigned char *begin = m_data.data();
+	uint64_t raw;
+	const unsigned char *p = Varint::get(begin + m_pos, begin + m_data.size(), raw);
+	if (!p) {
+		return false;
+	}
+	m_pos = static_cast<size_t>(p - begin);
+	value = static_cast<jlong>(raw);
+	return true;
+}
+
+bool Reader::getWord(Word &w)
+{
+	jint len;
+	if (!getInt(len, false) || len < 0) {
+		return false;
+	}
+	while (len--) {
+		jint sym;
+		if (!getInt(sym, false)) {
+			return false;
+		}
+		w.push_back(sym);
+	}
+	return true;
+}
+
+bool Reader::getWordsWithAnswers(Record &rec)
+{
+	jint count;
+	if (!getInt(count, false) || count < 0) {
+		return false;
+	}
+	for (jint i = 0; i < count; i++) {
+		rec.words.push_back(Word());
+		if (!getWord(rec.words.back())) {
+			return false;
+		}
+	}
+	rec.ints.resize(static_cast<size_t>(count));
+	for (jint i = 0; i < count; i++) {
+		if (!getInt(rec.ints[i], true)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool Reader::next(Record &rec)
+{
+	if (m_pos >= m_data.size()) {
+		return false;
+	}
+	rec.type = static_cast<RecordType>(m_data[m_pos++]);
+	rec.name.clear();
+	rec.ints.clear();
+	rec.words.clear();
+	rec.hash = 0;
+	rec.value = 0;
+
+	bool ok = false;
+	jint value;
+	switch (rec.type) {
+	case INIT: {
+		jint len;
+		if (!getInt(len, false) || len < 0 || static_cast<size_t>(len) > m_data.size() - m_pos) {
+			break;
+		}
+		rec.name.assign(reinterpret_cast<const char *>(&m_data[m_pos]), static_cast<size_t>(len));
+		m_pos += static_cast<size_t>(len);
+		jint numOpts;
+		if (!getInt(value, false) || !getInt(numOpts, false) || numOpts < 0) {
+			break;
+		}
+		rec.ints.push_back(value);
+		ok = true;
+		for (jint i = 0; ok && i < numOpts; i++) {
+			ok = getInt(value, true);
+			rec.ints.push_back(value);
+		}
+		break;
+	}
+	case ADVANCE:
+		ok = getInt(value, false);
+		rec.ints.push_back(value);
+		ok = ok && getInt(value, false);
+		rec.ints.push_back(value);
+		break;
+	case QUERIES: {
+		ok = getInt(value, false);
+		rec.ints.push_back(value);
+		const unsigned char *begin = m_data.data();
+		const unsigned char *p = ok ? Varint::get(begin + m_pos, begin + m_data.size(), rec.hash) : NULL;
+		ok = (p != NULL);
+		if (ok) {
+			m_pos = static_cast<size_t>(p - begin);
+		}
+		break;
+	}
+	case ANSWERS:
+	case SAMPLES:
+		ok = getWordsWithAnswers(rec);
+		break;
+	case COUNTEREXAMPLE:
+		rec.words.push_back(Word());
+		ok = getWord(rec.words.back());
+		break;
+	case CE_SHORTENING:
+		ok = getInt(value, false);
+		rec.ints.push_back(value);
+		break;
+	case POST_PROCESSING:
+		ok = getInt(value, false);
+		rec.ints.push_back(value);
+		ok = ok && getInt(value, false);
+		rec.ints.push_back(value);
+		break;
+	case SPILL:
+	case DEADLINE:
+		ok = getLong(rec.value);
+		break;
+	case CANCEL:
+	case FORK:
+		ok = true;
+		break;
+	}
+
+	if (!ok) {
+		m_failed = true;
+	}
+	return ok;
+}
+
+};
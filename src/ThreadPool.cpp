@@ -0,0 +1,143 @@
+/* Copyright (C) 2015 TU Dortmund
+ * This file is part of LearnLib, http://www.learnlib.de/.
+ * 
+ * LearnLib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 3.0 as published by the Free Software Foundation.
+ * 
+ * LearnLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with LearnLib; if not, see
+ * <http://www.gnu.de/documents/lgpl.en.html>.
+ */
+
+// ThreadPool.cpp
+// Implementation of the ThreadPool class
+
+#include <algorithm>
+
+#include "ThreadPool.hpp"
+
+ThreadPool::ThreadPool(unsigned numThreads)
+	: m_shutdown(false)
+{
+	if (!numThreads) {
+		numThreads = std::max(1u, std::thread::hardware_concurrency());
+	}
+	m_workers.reserve(numThreads);
+	for (unsigned i = 0; i < numThreads; i++) {
+		m_workers.push_back(std::thread(&ThreadPool::workerLoop, this));
+	}
+}
+
+ThreadPool::~ThreadPool(void)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_shutdown = true;
+	}
+	m_wake.notify_all();
+	for (size_t i = 0; i < m_workers.size(); i++) {
+		m_workers[i].join();
+	}
+}
+
+size_t ThreadPool::runItems(Job &job)
+{
+	size_t processed = 0;
+	for (;;) {
+		size_t i = job.next.fetch_add(1);
+		if (i >= job.numItems) {
+			break;
+		}
+		job.task(i);
+		processed++;
+	}
+	return processed;
+}
+
+void ThreadPool::parallelFor(size_t n, const Task &task)
+{
+	if (!n) {
+		return;
+	}
+
+	Job job(n, task);
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_jobs.push_back(&job);
+	lock.unlock();
+	m_wake.notify_all();
+
+	size_t processed = runItems(job);
+
+	lock.lock();
+	m_jobs.remove(&job);
+	job.finished += processed;
+	// Workers may still hold a reference to the job, even if all items
+	// have been claimed, so wait until the last one has let go of it.
+	while (job.finished < job.numItems || job.active) {
+		m_done.wait(lock);
+	}
+}
+
+void ThreadPool::workerLoop(void)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	for (;;) {
+		while (!m_shutdown && m_jobs.empty()) {
+			m_wake.wait(lock);
+		}
+		if (m_shutdown) {
+			return;
+		}
+
+		Job *job = m_jobs.front();
+		// Move the job to the back, so concurrent jobs are served in turn
+		m_jobs.pop_front();
+		m_jobs.push_back(job);
+		job->active++;
+		lock.unlock();
+
+		size_t processed = runItems(*job);
+
+		lock.lock();
+		if (job->next.load() >= job->numItems) {
+			m_jobs.remove(job);
+		}
+		job->finished += processed;
+		job->active--;
+		if (job->finished == job->numItems && !job->active) {
+			m_done.notify_all();
+		}
+	}
+}
+
+
+static std::mutex g_sharedMutex;
+static std::shared_ptr<ThreadPool> g_sharedPool;
+static unsigned g_sharedThreads = 0;
+
+std::shared_ptr<ThreadPool> ThreadPool::shared(void)
+{
+	std::lock_guard<std::mutex> lock(g_sharedMutex);
+	if (!g_sharedPool) {
+		g_sharedPool.reset(new ThreadPool(g_sharedThreads));
+	}
+	return g_sharedPool;
+}
+
+void ThreadPool::configureShared(unsigned numThreads)
+{
+	std::shared_ptr<ThreadPool> old;
+	{
+		std::lock_guard<std::mutex> lock(g_sharedMutex);
+		g_sharedThreads = numThreads;
+		old.swap(g_sharedPool);
+	}
+	// The previous pool is shut down once its last user releases it
+}